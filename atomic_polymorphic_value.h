@@ -0,0 +1,226 @@
+/* Copyright (c) 2016 The Polymorphic Value Authors. All Rights Reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+==============================================================================*/
+
+#ifndef ISOCPP_P0201_ATOMIC_POLYMORPHIC_VALUE_H_INCLUDED
+#define ISOCPP_P0201_ATOMIC_POLYMORPHIC_VALUE_H_INCLUDED
+
+#include <atomic>
+#include <cassert>
+#include <utility>
+
+#include "polymorphic_value.h"
+
+namespace isocpp_p0201 {
+
+////////////////////////////////////////////////////////////////////////////////
+// `atomic_polymorphic_value` class definition
+////////////////////////////////////////////////////////////////////////////////
+
+// An atomically replaceable `polymorphic_value<T>` for read-mostly shared
+// state. `load` returns a refcounted snapshot without taking a lock: the
+// published value lives behind a split-reference-counted pointer (an external
+// count packed next to the pointer, folded into the node's internal count
+// when the pointer is swung away), so readers contend only on a single
+// compare-exchange and snapshots stay valid for as long as they are held,
+// whatever the writers do.
+template <class T>
+class atomic_polymorphic_value {
+  struct node {
+    std::atomic<long> internal_count{0};
+    polymorphic_value<T> value;
+
+    explicit node(polymorphic_value<T> v) : value(std::move(v)) {}
+  };
+
+  struct counted_ptr {
+    node* p;
+    long external_count;
+  };
+
+  std::atomic<counted_ptr> head_;
+
+  // Folds a retired `counted_ptr`'s external count into the node's internal
+  // count. Every reader bump of the external count is matched by a later
+  // internal decrement, so the node dies when the internal count returns to
+  // zero. `keep` extra references are retained for the caller.
+  static void fold_external(const counted_ptr& old, long keep) {
+    if (!old.p) {
+      return;
+    }
+    const long delta = old.external_count - 1 + keep;
+    const long prev = old.p->internal_count.fetch_add(
+        delta, std::memory_order_acq_rel);
+    if (prev + delta == 0) {
+      delete old.p;
+    }
+  }
+
+  static void release_ref(node* p) {
+    if (p && p->internal_count.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      delete p;
+    }
+  }
+
+  // Acquires a reference to the currently published node by bumping the
+  // external count in place; the node cannot be freed while it is still the
+  // head, so the returned pointer is safe to dereference.
+  counted_ptr acquire() {
+    counted_ptr old = head_.load(std::memory_order_acquire);
+    for (;;) {
+      if (!old.p) {
+        return old;
+      }
+      counted_ptr bumped = old;
+      ++bumped.external_count;
+      if (head_.compare_exchange_weak(old, bumped, std::memory_order_acq_rel,
+                                      std::memory_order_acquire)) {
+        return bumped;
+      }
+    }
+  }
+
+ public:
+  // A stable, shared view of a published value. Holds a reference on the
+  // node it was loaded from; the underlying object outlives any writer
+  // replacing the published value.
+  class snapshot {
+    node* p_ = nullptr;
+
+    explicit snapshot(node* p) : p_(p) {}
+
+    friend class atomic_polymorphic_value;
+
+   public:
+    snapshot() = default;
+
+    snapshot(const snapshot& s) : p_(s.p_) {
+      if (p_) {
+        p_->internal_count.fetch_add(1, std::memory_order_relaxed);
+      }
+    }
+
+    snapshot(snapshot&& s) noexcept : p_(s.p_) { s.p_ = nullptr; }
+
+    snapshot& operator=(snapshot s) noexcept {
+      std::swap(p_, s.p_);
+      return *this;
+    }
+
+    ~snapshot() { release_ref(p_); }
+
+    explicit operator bool() const { return p_ != nullptr && bool(p_->value); }
+
+    const T* operator->() const {
+      assert(bool(*this));
+      return p_->value.operator->();
+    }
+
+    const T& operator*() const {
+      assert(bool(*this));
+      return *p_->value;
+    }
+
+    // The held `polymorphic_value`, e.g. for cloning before a
+    // `compare_exchange`.
+    const polymorphic_value<T>& value() const {
+      assert(p_);
+      return p_->value;
+    }
+  };
+
+  //
+  // Destructor
+  //
+
+  ~atomic_polymorphic_value() {
+    fold_external(head_.load(std::memory_order_acquire), 0);
+  }
+
+  //
+  // Constructors
+  //
+
+  atomic_polymorphic_value() { head_.store(counted_ptr{nullptr, 1}); }
+
+  explicit atomic_polymorphic_value(polymorphic_value<T> v) {
+    head_.store(counted_ptr{new node(std::move(v)), 1});
+  }
+
+  atomic_polymorphic_value(const atomic_polymorphic_value&) = delete;
+  atomic_polymorphic_value& operator=(const atomic_polymorphic_value&) = delete;
+
+  //
+  // Observers
+  //
+
+  // Lock-free on targets with a lock-free double-width compare-exchange.
+  bool is_lock_free() const { return head_.is_lock_free(); }
+
+  snapshot load() {
+    counted_ptr old = acquire();
+    if (!old.p) {
+      return snapshot();
+    }
+    // Convert the acquired external reference into an internal one: the
+    // bump made in `acquire` is repaid by `snapshot`'s destructor.
+    return snapshot(old.p);
+  }
+
+  //
+  // Modifiers
+  //
+
+  void store(polymorphic_value<T> v) { exchange(std::move(v)); }
+
+  // Replaces the published value and returns a snapshot of the previous one.
+  snapshot exchange(polymorphic_value<T> v) {
+    counted_ptr fresh{new node(std::move(v)), 1};
+    counted_ptr old = head_.exchange(fresh, std::memory_order_acq_rel);
+    if (!old.p) {
+      return snapshot();
+    }
+    fold_external(old, 1);
+    return snapshot(old.p);
+  }
+
+  // Publishes `desired` if the current value is still the one `expected` was
+  // loaded from. On failure `expected` is updated to a snapshot of the
+  // current value and `desired` is discarded; callers re-clone and retry.
+  bool compare_exchange(snapshot& expected, polymorphic_value<T> desired) {
+    counted_ptr fresh{new node(std::move(desired)), 1};
+    counted_ptr old = head_.load(std::memory_order_acquire);
+    for (;;) {
+      if (old.p != expected.p_) {
+        delete fresh.p;
+        expected = load();
+        return false;
+      }
+      if (head_.compare_exchange_weak(old, fresh, std::memory_order_acq_rel,
+                                      std::memory_order_acquire)) {
+        fold_external(old, 0);
+        return true;
+      }
+    }
+  }
+};
+
+}  // namespace isocpp_p0201
+
+#endif  // ISOCPP_P0201_ATOMIC_POLYMORPHIC_VALUE_H_INCLUDED
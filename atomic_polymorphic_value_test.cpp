@@ -0,0 +1,165 @@
+/* Copyright (c) 2016 The Polymorphic Value Authors. All Rights Reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+==============================================================================*/
+
+#include "atomic_polymorphic_value.h"
+
+#include <atomic>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#undef CATCH_CONFIG_WINDOWS_SEH
+#include "catch2/catch_test_macros.hpp"
+
+using namespace isocpp_p0201;
+
+namespace {
+struct Config {
+  virtual int version() const = 0;
+  virtual ~Config() = default;
+};
+
+struct TracedConfig : Config {
+  int version_ = 0;
+
+  TracedConfig(int v) : version_(v) { ++object_count; }
+
+  TracedConfig(const TracedConfig& c) : version_(c.version_) { ++object_count; }
+
+  ~TracedConfig() { --object_count; }
+
+  int version() const override { return version_; }
+
+  static std::atomic<size_t> object_count;
+};
+
+std::atomic<size_t> TracedConfig::object_count{0};
+
+polymorphic_value<Config> make_config(int version) {
+  return make_polymorphic_value<Config, TracedConfig>(version);
+}
+
+}  // namespace
+
+TEST_CASE("atomic_polymorphic_value default constructor",
+          "[atomic_polymorphic_value.constructors]") {
+  atomic_polymorphic_value<Config> a;
+
+  auto s = a.load();
+  CHECK(!bool(s));
+}
+
+TEST_CASE("atomic_polymorphic_value load returns the published value",
+          "[atomic_polymorphic_value.load]") {
+  atomic_polymorphic_value<Config> a(make_config(1));
+
+  auto s = a.load();
+  REQUIRE(bool(s));
+  CHECK(s->version() == 1);
+  CHECK((*s).version() == 1);
+}
+
+TEST_CASE("atomic_polymorphic_value snapshots survive store",
+          "[atomic_polymorphic_value.store]") {
+  CHECK(TracedConfig::object_count == 0);
+  {
+    atomic_polymorphic_value<Config> a(make_config(1));
+    auto old = a.load();
+
+    a.store(make_config(2));
+
+    CHECK(old->version() == 1);
+    CHECK(a.load()->version() == 2);
+    CHECK(TracedConfig::object_count == 2);
+
+    old = atomic_polymorphic_value<Config>::snapshot();
+    CHECK(TracedConfig::object_count == 1);
+  }
+  CHECK(TracedConfig::object_count == 0);
+}
+
+TEST_CASE("atomic_polymorphic_value exchange returns the previous value",
+          "[atomic_polymorphic_value.exchange]") {
+  atomic_polymorphic_value<Config> a(make_config(1));
+
+  auto old = a.exchange(make_config(2));
+
+  REQUIRE(bool(old));
+  CHECK(old->version() == 1);
+  CHECK(a.load()->version() == 2);
+}
+
+TEST_CASE("atomic_polymorphic_value compare_exchange",
+          "[atomic_polymorphic_value.compare_exchange]") {
+  atomic_polymorphic_value<Config> a(make_config(1));
+
+  auto expected = a.load();
+  CHECK(a.compare_exchange(expected, make_config(2)));
+  CHECK(a.load()->version() == 2);
+
+  // `expected` is now stale: the exchange fails and refreshes it.
+  CHECK(!a.compare_exchange(expected, make_config(3)));
+  CHECK(expected->version() == 2);
+  CHECK(a.load()->version() == 2);
+
+  CHECK(a.compare_exchange(expected, make_config(3)));
+  CHECK(a.load()->version() == 3);
+}
+
+TEST_CASE("atomic_polymorphic_value concurrent readers and writer",
+          "[atomic_polymorphic_value.threads]") {
+  CHECK(TracedConfig::object_count == 0);
+  {
+    atomic_polymorphic_value<Config> a(make_config(0));
+    std::atomic<bool> stop{false};
+    std::atomic<bool> regressed{false};
+
+    // Catch assertions are not thread-safe; readers record failures and the
+    // main thread checks them after joining.
+    std::vector<std::thread> readers;
+    for (int r = 0; r != 4; ++r) {
+      readers.emplace_back([&a, &stop, &regressed] {
+        int last = 0;
+        while (!stop.load(std::memory_order_relaxed)) {
+          auto s = a.load();
+          const int v = s->version();
+          // Published versions only increase.
+          if (v < last) {
+            regressed.store(true);
+          }
+          last = v;
+        }
+      });
+    }
+
+    for (int v = 1; v <= 1000; ++v) {
+      a.store(make_config(v));
+    }
+    stop.store(true);
+
+    for (std::thread& t : readers) {
+      t.join();
+    }
+
+    CHECK(!regressed);
+    CHECK(a.load()->version() == 1000);
+  }
+  CHECK(TracedConfig::object_count == 0);
+}
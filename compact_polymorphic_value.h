@@ -0,0 +1,242 @@
+/* Copyright (c) 2016 The Polymorphic Value Authors. All Rights Reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+==============================================================================*/
+
+#ifndef ISOCPP_P0201_COMPACT_POLYMORPHIC_VALUE_H_INCLUDED
+#define ISOCPP_P0201_COMPACT_POLYMORPHIC_VALUE_H_INCLUDED
+
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace isocpp_p0201 {
+
+template <class T>
+class compact_polymorphic_value;
+
+namespace detail {
+
+////////////////////////////////////////////////////////////////////////////
+// Implementation detail classes
+////////////////////////////////////////////////////////////////////////////
+
+// Control block whose header stores the byte offset from the block to the
+// `T` subobject, so the handle can recover the object pointer with plain
+// pointer arithmetic instead of a second handle word or a virtual call.
+template <class T>
+class compact_control_block {
+  std::ptrdiff_t offset_ = 0;
+
+ protected:
+  // Records the offset to `t`; called by derived constructors once the
+  // stored object's address is known.
+  void set_object(const T* t) noexcept {
+    offset_ = reinterpret_cast<const char*>(t) -
+              reinterpret_cast<const char*>(this);
+  }
+
+ public:
+  virtual ~compact_control_block() = default;
+
+  virtual compact_control_block* clone() const = 0;
+
+  virtual void destroy() noexcept { delete this; }
+
+  // Non-virtual: one field load and an add.
+  T* ptr() noexcept {
+    return reinterpret_cast<T*>(reinterpret_cast<char*>(this) + offset_);
+  }
+
+  const T* ptr() const noexcept {
+    return reinterpret_cast<const T*>(reinterpret_cast<const char*>(this) +
+                                      offset_);
+  }
+};
+
+template <class T, class U>
+class compact_direct_control_block final : public compact_control_block<T> {
+  static_assert(!std::is_reference<U>::value, "");
+  U u_;
+
+ public:
+  template <class... Ts>
+  explicit compact_direct_control_block(Ts&&... ts)
+      : u_(std::forward<Ts>(ts)...) {
+    this->set_object(std::addressof(u_));
+  }
+
+  compact_control_block<T>* clone() const override {
+    return new compact_direct_control_block(u_);
+  }
+};
+
+}  // end namespace detail
+
+////////////////////////////////////////////////////////////////////////////////
+// `compact_polymorphic_value` class definition
+////////////////////////////////////////////////////////////////////////////////
+
+// A single-word `polymorphic_value`: the handle is only the control-block
+// pointer, halving the footprint of large columns of values. The object
+// pointer that `polymorphic_value` caches in its second word is instead
+// recovered from a byte offset stored in the control-block header, so
+// dereference stays one indirection plus an add and never calls a virtual
+// function.
+template <class T>
+class compact_polymorphic_value {
+  static_assert(!std::is_union<T>::value, "");
+  static_assert(std::is_class<T>::value, "");
+
+  detail::compact_control_block<T>* cb_ = nullptr;
+
+  template <class T_, class U, class... Ts>
+  friend compact_polymorphic_value<T_> make_compact_polymorphic_value(
+      Ts&&... ts);
+
+  void reset() noexcept {
+    if (cb_) {
+      cb_->destroy();
+      cb_ = nullptr;
+    }
+  }
+
+ public:
+  //
+  // Destructor
+  //
+
+  ~compact_polymorphic_value() { reset(); }
+
+  //
+  // Constructors
+  //
+
+  compact_polymorphic_value() = default;
+
+  compact_polymorphic_value(std::nullptr_t) {}
+
+  template <class U,
+            class V = std::enable_if_t<
+                std::is_convertible<std::decay_t<U>*, T*>::value>,
+            class... Ts>
+  explicit compact_polymorphic_value(std::in_place_type_t<U>, Ts&&... ts)
+      : cb_(new detail::compact_direct_control_block<T, U>(
+            std::forward<Ts>(ts)...)) {}
+
+  //
+  // Copy-constructors
+  //
+
+  compact_polymorphic_value(const compact_polymorphic_value& p) {
+    if (p.cb_) {
+      cb_ = p.cb_->clone();
+    }
+  }
+
+  //
+  // Move-constructors
+  //
+
+  compact_polymorphic_value(compact_polymorphic_value&& p) noexcept
+      : cb_(p.cb_) {
+    p.cb_ = nullptr;
+  }
+
+  //
+  // Assignment
+  //
+
+  compact_polymorphic_value& operator=(const compact_polymorphic_value& p) {
+    if (std::addressof(p) == this) {
+      return *this;
+    }
+    compact_polymorphic_value tmp(p);
+    swap(tmp);
+    return *this;
+  }
+
+  compact_polymorphic_value& operator=(
+      compact_polymorphic_value&& p) noexcept {
+    if (std::addressof(p) == this) {
+      return *this;
+    }
+    reset();
+    cb_ = p.cb_;
+    p.cb_ = nullptr;
+    return *this;
+  }
+
+  //
+  // Modifiers
+  //
+
+  void swap(compact_polymorphic_value& p) noexcept { std::swap(cb_, p.cb_); }
+
+  //
+  // Observers
+  //
+
+  explicit operator bool() const { return cb_ != nullptr; }
+
+  const T* operator->() const {
+    assert(cb_);
+    return cb_->ptr();
+  }
+
+  const T& operator*() const {
+    assert(cb_);
+    return *cb_->ptr();
+  }
+
+  T* operator->() {
+    assert(cb_);
+    return cb_->ptr();
+  }
+
+  T& operator*() {
+    assert(cb_);
+    return *cb_->ptr();
+  }
+};
+
+//
+// compact_polymorphic_value creation
+//
+template <class T, class U = T, class... Ts>
+compact_polymorphic_value<T> make_compact_polymorphic_value(Ts&&... ts) {
+  compact_polymorphic_value<T> p;
+  p.cb_ =
+      new detail::compact_direct_control_block<T, U>(std::forward<Ts>(ts)...);
+  return p;
+}
+
+//
+// non-member swap
+//
+template <class T>
+void swap(compact_polymorphic_value<T>& t,
+          compact_polymorphic_value<T>& u) noexcept {
+  t.swap(u);
+}
+
+}  // namespace isocpp_p0201
+
+#endif  // ISOCPP_P0201_COMPACT_POLYMORPHIC_VALUE_H_INCLUDED
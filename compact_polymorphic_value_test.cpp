@@ -0,0 +1,161 @@
+/* Copyright (c) 2016 The Polymorphic Value Authors. All Rights Reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+==============================================================================*/
+
+#include "compact_polymorphic_value.h"
+
+#include <utility>
+
+#undef CATCH_CONFIG_WINDOWS_SEH
+#include "catch2/catch_test_macros.hpp"
+
+using namespace isocpp_p0201;
+
+namespace {
+struct CompactBase {
+  virtual int value() const = 0;
+  virtual void set_value(int) = 0;
+  virtual ~CompactBase() = default;
+};
+
+struct CompactDerived : CompactBase {
+  int value_ = 0;
+
+  CompactDerived(int v) : value_(v) { ++object_count; }
+
+  CompactDerived(const CompactDerived& d) : value_(d.value_) {
+    ++object_count;
+  }
+
+  ~CompactDerived() { --object_count; }
+
+  int value() const override { return value_; }
+
+  void set_value(int i) override { value_ = i; }
+
+  static size_t object_count;
+};
+
+size_t CompactDerived::object_count = 0;
+
+struct Padding {
+  double d_[4] = {};
+
+  virtual ~Padding() = default;
+};
+
+// The interface subobject is at a non-zero offset in this type, so the
+// stored offset is what makes dereference land on the right address.
+struct OffsetDerived : Padding, CompactBase {
+  int value_ = 0;
+
+  OffsetDerived(int v) : value_(v) {}
+
+  int value() const override { return value_; }
+
+  void set_value(int i) override { value_ = i; }
+};
+
+}  // namespace
+
+TEST_CASE("compact_polymorphic_value is one pointer wide",
+          "[compact_polymorphic_value.layout]") {
+  static_assert(
+      sizeof(compact_polymorphic_value<CompactBase>) == sizeof(void*), "");
+}
+
+TEST_CASE("compact_polymorphic_value default and nullptr constructors",
+          "[compact_polymorphic_value.constructors]") {
+  compact_polymorphic_value<CompactBase> p;
+  CHECK(!bool(p));
+
+  compact_polymorphic_value<CompactBase> q(nullptr);
+  CHECK(!bool(q));
+}
+
+TEST_CASE("compact_polymorphic_value in-place construction and access",
+          "[compact_polymorphic_value.constructors]") {
+  compact_polymorphic_value<CompactBase> p(
+      std::in_place_type_t<CompactDerived>{}, 7);
+
+  REQUIRE(bool(p));
+  CHECK(p->value() == 7);
+  CHECK((*p).value() == 7);
+
+  p->set_value(8);
+  CHECK(p->value() == 8);
+}
+
+TEST_CASE("compact_polymorphic_value handles offset base subobjects",
+          "[compact_polymorphic_value.layout]") {
+  auto p = make_compact_polymorphic_value<CompactBase, OffsetDerived>(5);
+
+  REQUIRE(bool(p));
+  CHECK(p->value() == 5);
+
+  compact_polymorphic_value<CompactBase> q(p);
+  CHECK(q->value() == 5);
+}
+
+TEST_CASE("compact_polymorphic_value copy is deep",
+          "[compact_polymorphic_value.copy]") {
+  CHECK(CompactDerived::object_count == 0);
+  {
+    auto p = make_compact_polymorphic_value<CompactBase, CompactDerived>(1);
+    compact_polymorphic_value<CompactBase> q(p);
+
+    CHECK(CompactDerived::object_count == 2);
+    CHECK(q.operator->() != p.operator->());
+
+    q->set_value(2);
+    CHECK(p->value() == 1);
+
+    p = q;
+    CHECK(p->value() == 2);
+  }
+  CHECK(CompactDerived::object_count == 0);
+}
+
+TEST_CASE("compact_polymorphic_value move transfers ownership",
+          "[compact_polymorphic_value.move]") {
+  auto p = make_compact_polymorphic_value<CompactBase, CompactDerived>(3);
+  const CompactBase* stored = p.operator->();
+
+  compact_polymorphic_value<CompactBase> q(std::move(p));
+
+  CHECK(!bool(p));
+  REQUIRE(bool(q));
+  CHECK(q.operator->() == stored);
+  CHECK(CompactDerived::object_count == 1);
+
+  p = std::move(q);
+  CHECK(!bool(q));
+  CHECK(p->value() == 3);
+}
+
+TEST_CASE("compact_polymorphic_value swap",
+          "[compact_polymorphic_value.swap]") {
+  auto p = make_compact_polymorphic_value<CompactBase, CompactDerived>(1);
+  auto q = make_compact_polymorphic_value<CompactBase, CompactDerived>(2);
+
+  swap(p, q);
+
+  CHECK(p->value() == 2);
+  CHECK(q->value() == 1);
+}
@@ -0,0 +1,250 @@
+/* Copyright (c) 2016 The Polymorphic Value Authors. All Rights Reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+==============================================================================*/
+
+#ifndef ISOCPP_P0201_COW_POLYMORPHIC_VALUE_H_INCLUDED
+#define ISOCPP_P0201_COW_POLYMORPHIC_VALUE_H_INCLUDED
+
+#include <atomic>
+#include <cassert>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include "polymorphic_value.h"
+
+namespace isocpp_p0201 {
+
+namespace detail {
+
+////////////////////////////////////////////////////////////////////////////
+// Implementation detail classes
+////////////////////////////////////////////////////////////////////////////
+
+// Shared state for `cow_polymorphic_value`: the usual control block plus an
+// atomic reference count. Copies of the owning value share this state;
+// `clone()` is deferred until a sharing owner needs mutable access.
+template <class T>
+struct cow_shared_state {
+  std::atomic<long> count{1};
+  std::unique_ptr<control_block<T>, control_block_deleter> cb;
+  T* ptr = nullptr;
+
+  explicit cow_shared_state(
+      std::unique_ptr<control_block<T>, control_block_deleter> cb_)
+      : cb(std::move(cb_)), ptr(cb->ptr()) {}
+};
+
+}  // end namespace detail
+
+template <class T>
+class cow_polymorphic_value;
+
+template <class T>
+struct is_cow_polymorphic_value : std::false_type {};
+
+template <class T>
+struct is_cow_polymorphic_value<cow_polymorphic_value<T>> : std::true_type {};
+
+////////////////////////////////////////////////////////////////////////////////
+// `cow_polymorphic_value` class definition
+////////////////////////////////////////////////////////////////////////////////
+
+// A copy-on-write polymorphic value. Copies bump an atomic reference count and
+// share the stored object; const accessors never copy. Non-const accessors
+// perform the deferred `control_block::clone()` only when the object is
+// shared, so read-only fan-out of large objects is O(1) per copy.
+template <class T>
+class cow_polymorphic_value {
+  static_assert(!std::is_union<T>::value, "");
+  static_assert(std::is_class<T>::value, "");
+
+  template <class T_, class U, class... Ts>
+  friend cow_polymorphic_value<T_> make_cow_polymorphic_value(Ts&&... ts);
+
+  detail::cow_shared_state<T>* state_ = nullptr;
+
+  void release() noexcept {
+    if (state_ &&
+        state_->count.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      delete state_;
+    }
+    state_ = nullptr;
+  }
+
+  void retain(detail::cow_shared_state<T>* state) noexcept {
+    state_ = state;
+    if (state_) {
+      state_->count.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  // Ensures exclusive ownership of the stored object, cloning it if shared.
+  void detach() {
+    assert(state_);
+    if (state_->count.load(std::memory_order_acquire) == 1) {
+      return;
+    }
+    auto* fresh = new detail::cow_shared_state<T>(state_->cb->clone());
+    release();
+    state_ = fresh;
+  }
+
+ public:
+  //
+  // Destructor
+  //
+
+  ~cow_polymorphic_value() { release(); }
+
+  //
+  // Constructors
+  //
+
+  constexpr cow_polymorphic_value() {}
+
+  constexpr cow_polymorphic_value(std::nullptr_t) {}
+
+  //
+  // Copy-constructors
+  //
+
+  cow_polymorphic_value(const cow_polymorphic_value& p) { retain(p.state_); }
+
+  //
+  // Move-constructors
+  //
+
+  cow_polymorphic_value(cow_polymorphic_value&& p) noexcept
+      : state_(p.state_) {
+    p.state_ = nullptr;
+  }
+
+  //
+  // In-place constructor
+  //
+
+  template <class U,
+            class V = std::enable_if_t<
+                std::is_convertible<std::decay_t<U>*, T*>::value &&
+                !is_cow_polymorphic_value<std::decay_t<U>>::value>,
+            class... Ts>
+  explicit cow_polymorphic_value(std::in_place_type_t<U>, Ts&&... ts)
+      : state_(new detail::cow_shared_state<T>(
+            std::unique_ptr<detail::direct_control_block<T, U>,
+                            detail::control_block_deleter>(
+                new detail::direct_control_block<T, U>(
+                    std::forward<Ts>(ts)...)))) {}
+
+  //
+  // Assignment
+  //
+
+  cow_polymorphic_value& operator=(const cow_polymorphic_value& p) {
+    if (std::addressof(p) == this) {
+      return *this;
+    }
+
+    release();
+    retain(p.state_);
+    return *this;
+  }
+
+  //
+  // Move-assignment
+  //
+
+  cow_polymorphic_value& operator=(cow_polymorphic_value&& p) noexcept {
+    if (std::addressof(p) == this) {
+      return *this;
+    }
+
+    release();
+    state_ = p.state_;
+    p.state_ = nullptr;
+    return *this;
+  }
+
+  //
+  // Modifiers
+  //
+
+  void swap(cow_polymorphic_value& p) noexcept {
+    using std::swap;
+    swap(state_, p.state_);
+  }
+
+  //
+  // Observers
+  //
+
+  constexpr explicit operator bool() const { return state_ != nullptr; }
+
+  // Number of cow_polymorphic_value objects sharing the stored object.
+  long use_count() const noexcept {
+    return state_ ? state_->count.load(std::memory_order_acquire) : 0;
+  }
+
+  const T* operator->() const {
+    assert(state_);
+    return state_->ptr;
+  }
+
+  const T& operator*() const {
+    assert(state_);
+    return *state_->ptr;
+  }
+
+  T* operator->() {
+    assert(state_);
+    detach();
+    return state_->ptr;
+  }
+
+  T& operator*() {
+    assert(state_);
+    detach();
+    return *state_->ptr;
+  }
+};
+
+//
+// cow_polymorphic_value creation
+//
+template <class T, class U = T, class... Ts>
+cow_polymorphic_value<T> make_cow_polymorphic_value(Ts&&... ts) {
+  cow_polymorphic_value<T> p;
+  p.state_ = new detail::cow_shared_state<T>(
+      std::unique_ptr<detail::direct_control_block<T, U>,
+                      detail::control_block_deleter>(
+          new detail::direct_control_block<T, U>(std::forward<Ts>(ts)...)));
+  return p;
+}
+
+//
+// non-member swap
+//
+template <class T>
+void swap(cow_polymorphic_value<T>& t, cow_polymorphic_value<T>& u) noexcept {
+  t.swap(u);
+}
+
+}  // namespace isocpp_p0201
+
+#endif  // ISOCPP_P0201_COW_POLYMORPHIC_VALUE_H_INCLUDED
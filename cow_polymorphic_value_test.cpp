@@ -0,0 +1,168 @@
+/* Copyright (c) 2016 The Polymorphic Value Authors. All Rights Reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+==============================================================================*/
+
+#include "cow_polymorphic_value.h"
+
+#include <utility>
+
+#undef CATCH_CONFIG_WINDOWS_SEH
+#include "catch2/catch_test_macros.hpp"
+
+using namespace isocpp_p0201;
+
+namespace {
+struct CowBase {
+  virtual int value() const = 0;
+  virtual void set_value(int) = 0;
+  virtual ~CowBase() = default;
+};
+
+struct CowDerived : CowBase {
+  int value_ = 0;
+
+  CowDerived(int v) : value_(v) { ++object_count; }
+
+  CowDerived(const CowDerived& d) : value_(d.value_) { ++object_count; }
+
+  ~CowDerived() { --object_count; }
+
+  int value() const override { return value_; }
+
+  void set_value(int i) override { value_ = i; }
+
+  static size_t object_count;
+};
+
+size_t CowDerived::object_count = 0;
+
+}  // namespace
+
+TEST_CASE("cow_polymorphic_value default constructor",
+          "[cow_polymorphic_value.constructors]") {
+  cow_polymorphic_value<CowBase> p;
+
+  REQUIRE_FALSE(bool(p));
+  REQUIRE(p.use_count() == 0);
+}
+
+TEST_CASE("cow_polymorphic_value copies share until written",
+          "[cow_polymorphic_value.cow]") {
+  GIVEN("An in-place-constructed cow_polymorphic_value and a copy") {
+    REQUIRE(CowDerived::object_count == 0);
+
+    cow_polymorphic_value<CowBase> p(std::in_place_type<CowDerived>, 7);
+    cow_polymorphic_value<CowBase> q(p);
+
+    THEN("no clone has occurred and the object is shared") {
+      REQUIRE(CowDerived::object_count == 1);
+      REQUIRE(p.use_count() == 2);
+      REQUIRE(q.use_count() == 2);
+      REQUIRE(std::as_const(p).operator->() ==
+              std::as_const(q).operator->());
+      REQUIRE(std::as_const(q)->value() == 7);
+    }
+
+    WHEN("a sharing owner takes mutable access") {
+      q->set_value(99);
+
+      THEN("only the writer detaches; the other owner is unchanged") {
+        REQUIRE(CowDerived::object_count == 2);
+        REQUIRE(p.use_count() == 1);
+        REQUIRE(q.use_count() == 1);
+        REQUIRE(std::as_const(p)->value() == 7);
+        REQUIRE(std::as_const(q)->value() == 99);
+      }
+    }
+  }
+  REQUIRE(CowDerived::object_count == 0);
+}
+
+TEST_CASE("cow_polymorphic_value sole owner mutates in place",
+          "[cow_polymorphic_value.cow]") {
+  cow_polymorphic_value<CowBase> p(std::in_place_type<CowDerived>, 7);
+  const auto* stored = std::as_const(p).operator->();
+
+  p->set_value(99);
+
+  REQUIRE(std::as_const(p).operator->() == stored);
+  REQUIRE(CowDerived::object_count == 1);
+  REQUIRE(std::as_const(p)->value() == 99);
+}
+
+TEST_CASE("cow_polymorphic_value assignment shares",
+          "[cow_polymorphic_value.assignment]") {
+  cow_polymorphic_value<CowBase> p(std::in_place_type<CowDerived>, 7);
+  cow_polymorphic_value<CowBase> q(std::in_place_type<CowDerived>, 87);
+
+  REQUIRE(CowDerived::object_count == 2);
+
+  q = p;
+
+  REQUIRE(CowDerived::object_count == 1);
+  REQUIRE(p.use_count() == 2);
+  REQUIRE(std::as_const(q)->value() == 7);
+
+  q = q;
+
+  REQUIRE(p.use_count() == 2);
+}
+
+TEST_CASE("cow_polymorphic_value move does not clone",
+          "[cow_polymorphic_value.constructors]") {
+  cow_polymorphic_value<CowBase> p(std::in_place_type<CowDerived>, 7);
+  const auto* stored = std::as_const(p).operator->();
+
+  cow_polymorphic_value<CowBase> q(std::move(p));
+
+  REQUIRE_FALSE(bool(p));
+  REQUIRE(q.use_count() == 1);
+  REQUIRE(std::as_const(q).operator->() == stored);
+
+  cow_polymorphic_value<CowBase> r;
+  r = std::move(q);
+
+  REQUIRE_FALSE(bool(q));
+  REQUIRE(std::as_const(r).operator->() == stored);
+  REQUIRE(CowDerived::object_count == 1);
+}
+
+TEST_CASE("make_cow_polymorphic_value",
+          "[cow_polymorphic_value.make_cow_polymorphic_value]") {
+  auto p = make_cow_polymorphic_value<CowBase, CowDerived>(7);
+  static_assert(
+      std::is_same<decltype(p), cow_polymorphic_value<CowBase>>::value, "");
+  REQUIRE(std::as_const(p)->value() == 7);
+  REQUIRE(p.use_count() == 1);
+}
+
+TEST_CASE("cow_polymorphic_value destruction releases the last reference",
+          "[cow_polymorphic_value.destructor]") {
+  REQUIRE(CowDerived::object_count == 0);
+  {
+    cow_polymorphic_value<CowBase> p(std::in_place_type<CowDerived>, 7);
+    {
+      cow_polymorphic_value<CowBase> q(p);
+      REQUIRE(CowDerived::object_count == 1);
+    }
+    REQUIRE(CowDerived::object_count == 1);
+    REQUIRE(p.use_count() == 1);
+  }
+  REQUIRE(CowDerived::object_count == 0);
+}
@@ -0,0 +1,273 @@
+/* Copyright (c) 2016 The Polymorphic Value Authors. All Rights Reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+==============================================================================*/
+
+#ifndef ISOCPP_P0201_FLAT_POLYMORPHIC_VALUE_H_INCLUDED
+#define ISOCPP_P0201_FLAT_POLYMORPHIC_VALUE_H_INCLUDED
+
+#include <cassert>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace isocpp_p0201 {
+
+namespace detail {
+
+////////////////////////////////////////////////////////////////////////////
+// Implementation detail classes
+////////////////////////////////////////////////////////////////////////////
+
+// Flat dispatch table used by `flat_polymorphic_value` in place of a virtual
+// control block: one static constexpr table per (T, U) pair, selected once at
+// construction. Calls through it are plain indirect calls with no vtable load
+// and no RTTI. `ptr` is a function rather than a stored byte offset so that
+// derived-to-base conversions involving virtual bases remain correct.
+template <class T>
+struct flat_vtable {
+  void* (*clone)(const void* storage);
+  void (*destroy)(void* storage) noexcept;
+  T* (*ptr)(void* storage) noexcept;
+};
+
+// Heap storage for a `U`; no vtable pointer, the owning value holds the
+// dispatch table.
+template <class T, class U>
+struct flat_storage {
+  static_assert(!std::is_reference<U>::value, "");
+  U u_;
+
+  template <class... Ts>
+  explicit flat_storage(Ts&&... ts) : u_(U(std::forward<Ts>(ts)...)) {}
+};
+
+template <class T, class U>
+struct flat_ops {
+  static void* clone(const void* storage) {
+    return new flat_storage<T, U>(
+        *static_cast<const flat_storage<T, U>*>(storage));
+  }
+
+  static void destroy(void* storage) noexcept {
+    delete static_cast<flat_storage<T, U>*>(storage);
+  }
+
+  static T* ptr(void* storage) noexcept {
+    return std::addressof(static_cast<flat_storage<T, U>*>(storage)->u_);
+  }
+
+  static constexpr flat_vtable<T> vtable = {&clone, &destroy, &ptr};
+};
+
+template <class T, class U>
+constexpr flat_vtable<T> flat_ops<T, U>::vtable;
+
+}  // end namespace detail
+
+template <class T>
+class flat_polymorphic_value;
+
+template <class T>
+struct is_flat_polymorphic_value : std::false_type {};
+
+template <class T>
+struct is_flat_polymorphic_value<flat_polymorphic_value<T>> : std::true_type {
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// `flat_polymorphic_value` class definition
+////////////////////////////////////////////////////////////////////////////////
+
+// A polymorphic value type whose type erasure is a flat table of plain
+// function pointers rather than a virtual control block. Copy and destroy are
+// single indirect calls with no vtable load, and the per-object footprint is
+// one allocation holding only the stored object.
+template <class T>
+class flat_polymorphic_value {
+  static_assert(!std::is_union<T>::value, "");
+  static_assert(std::is_class<T>::value, "");
+
+  template <class T_, class U, class... Ts>
+  friend flat_polymorphic_value<T_> make_flat_polymorphic_value(Ts&&... ts);
+
+  T* ptr_ = nullptr;
+  void* storage_ = nullptr;
+  const detail::flat_vtable<T>* ops_ = nullptr;
+
+  template <class U, class... Ts>
+  void construct(Ts&&... ts) {
+    auto* storage = new detail::flat_storage<T, U>(std::forward<Ts>(ts)...);
+    storage_ = storage;
+    ops_ = &detail::flat_ops<T, U>::vtable;
+    ptr_ = std::addressof(storage->u_);
+  }
+
+  void reset() noexcept {
+    if (storage_) {
+      ops_->destroy(storage_);
+      storage_ = nullptr;
+      ops_ = nullptr;
+      ptr_ = nullptr;
+    }
+  }
+
+ public:
+  //
+  // Destructor
+  //
+
+  ~flat_polymorphic_value() { reset(); }
+
+  //
+  // Constructors
+  //
+
+  constexpr flat_polymorphic_value() {}
+
+  constexpr flat_polymorphic_value(std::nullptr_t) {}
+
+  //
+  // Copy-constructors
+  //
+
+  flat_polymorphic_value(const flat_polymorphic_value& p) {
+    if (!p) {
+      return;
+    }
+    storage_ = p.ops_->clone(p.storage_);
+    ops_ = p.ops_;
+    ptr_ = ops_->ptr(storage_);
+  }
+
+  //
+  // Move-constructors
+  //
+
+  flat_polymorphic_value(flat_polymorphic_value&& p) noexcept
+      : ptr_(p.ptr_), storage_(p.storage_), ops_(p.ops_) {
+    p.ptr_ = nullptr;
+    p.storage_ = nullptr;
+    p.ops_ = nullptr;
+  }
+
+  //
+  // In-place constructor
+  //
+
+  template <class U,
+            class V = std::enable_if_t<
+                std::is_convertible<std::decay_t<U>*, T*>::value &&
+                !is_flat_polymorphic_value<std::decay_t<U>>::value>,
+            class... Ts>
+  explicit flat_polymorphic_value(std::in_place_type_t<U>, Ts&&... ts) {
+    construct<U>(std::forward<Ts>(ts)...);
+  }
+
+  //
+  // Assignment
+  //
+
+  flat_polymorphic_value& operator=(const flat_polymorphic_value& p) {
+    if (std::addressof(p) == this) {
+      return *this;
+    }
+
+    flat_polymorphic_value tmp(p);
+    *this = std::move(tmp);
+    return *this;
+  }
+
+  //
+  // Move-assignment
+  //
+
+  flat_polymorphic_value& operator=(flat_polymorphic_value&& p) noexcept {
+    if (std::addressof(p) == this) {
+      return *this;
+    }
+
+    reset();
+    ptr_ = p.ptr_;
+    storage_ = p.storage_;
+    ops_ = p.ops_;
+    p.ptr_ = nullptr;
+    p.storage_ = nullptr;
+    p.ops_ = nullptr;
+    return *this;
+  }
+
+  //
+  // Modifiers
+  //
+
+  void swap(flat_polymorphic_value& p) noexcept {
+    using std::swap;
+    swap(ptr_, p.ptr_);
+    swap(storage_, p.storage_);
+    swap(ops_, p.ops_);
+  }
+
+  //
+  // Observers
+  //
+
+  constexpr explicit operator bool() const { return storage_ != nullptr; }
+
+  constexpr const T* operator->() const {
+    assert(ptr_);
+    return ptr_;
+  }
+
+  constexpr const T& operator*() const {
+    assert(*this);
+    return *ptr_;
+  }
+
+  constexpr T* operator->() {
+    assert(*this);
+    return ptr_;
+  }
+
+  constexpr T& operator*() {
+    assert(*this);
+    return *ptr_;
+  }
+};
+
+//
+// flat_polymorphic_value creation
+//
+template <class T, class U = T, class... Ts>
+flat_polymorphic_value<T> make_flat_polymorphic_value(Ts&&... ts) {
+  flat_polymorphic_value<T> p;
+  p.template construct<U>(std::forward<Ts>(ts)...);
+  return p;
+}
+
+//
+// non-member swap
+//
+template <class T>
+void swap(flat_polymorphic_value<T>& t, flat_polymorphic_value<T>& u) noexcept {
+  t.swap(u);
+}
+
+}  // namespace isocpp_p0201
+
+#endif  // ISOCPP_P0201_FLAT_POLYMORPHIC_VALUE_H_INCLUDED
@@ -0,0 +1,183 @@
+/* Copyright (c) 2016 The Polymorphic Value Authors. All Rights Reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+==============================================================================*/
+
+#include "flat_polymorphic_value.h"
+
+#include <utility>
+
+#undef CATCH_CONFIG_WINDOWS_SEH
+#include "catch2/catch_test_macros.hpp"
+
+using namespace isocpp_p0201;
+
+namespace {
+struct FlatBase {
+  virtual int value() const = 0;
+  virtual void set_value(int) = 0;
+  virtual ~FlatBase() = default;
+};
+
+struct FlatDerived : FlatBase {
+  int value_ = 0;
+
+  FlatDerived() { ++object_count; }
+
+  FlatDerived(const FlatDerived& d) : value_(d.value_) { ++object_count; }
+
+  FlatDerived(int v) : value_(v) { ++object_count; }
+
+  ~FlatDerived() { --object_count; }
+
+  int value() const override { return value_; }
+
+  void set_value(int i) override { value_ = i; }
+
+  static size_t object_count;
+};
+
+size_t FlatDerived::object_count = 0;
+
+struct FlatBaseA {
+  int a_ = 1;
+  virtual ~FlatBaseA() = default;
+};
+
+struct FlatBaseB {
+  int b_ = 2;
+  virtual ~FlatBaseB() = default;
+};
+
+struct FlatMultiplyDerived : FlatBaseA, FlatBaseB {
+  int value_ = 0;
+  FlatMultiplyDerived(int value) : value_(value) {}
+};
+
+}  // namespace
+
+TEST_CASE("flat_polymorphic_value default constructor",
+          "[flat_polymorphic_value.constructors]") {
+  flat_polymorphic_value<FlatBase> p;
+
+  REQUIRE_FALSE(bool(p));
+}
+
+TEST_CASE("flat_polymorphic_value in-place constructor",
+          "[flat_polymorphic_value.constructors]") {
+  flat_polymorphic_value<FlatBase> p(std::in_place_type<FlatDerived>, 7);
+
+  REQUIRE(bool(p));
+  REQUIRE(p->value() == 7);
+}
+
+TEST_CASE("flat_polymorphic_value copy constructor",
+          "[flat_polymorphic_value.constructors]") {
+  GIVEN("An in-place-constructed flat_polymorphic_value") {
+    REQUIRE(FlatDerived::object_count == 0);
+
+    flat_polymorphic_value<FlatBase> p(std::in_place_type<FlatDerived>, 7);
+    flat_polymorphic_value<FlatBase> q(p);
+
+    THEN("values are distinct") {
+      REQUIRE(q.operator->() != p.operator->());
+      REQUIRE(q->value() == 7);
+      REQUIRE(FlatDerived::object_count == 2);
+    }
+
+    WHEN("The original is modified") {
+      p->set_value(99);
+      THEN("the copy is unchanged") { REQUIRE(q->value() == 7); }
+    }
+  }
+  REQUIRE(FlatDerived::object_count == 0);
+}
+
+TEST_CASE("flat_polymorphic_value move constructor",
+          "[flat_polymorphic_value.constructors]") {
+  flat_polymorphic_value<FlatBase> p(std::in_place_type<FlatDerived>, 7);
+  const auto* stored = p.operator->();
+
+  flat_polymorphic_value<FlatBase> q(std::move(p));
+
+  REQUIRE_FALSE(bool(p));
+  REQUIRE(q.operator->() == stored);
+  REQUIRE(q->value() == 7);
+  REQUIRE(FlatDerived::object_count == 1);
+}
+
+TEST_CASE("flat_polymorphic_value assignment",
+          "[flat_polymorphic_value.assignment]") {
+  flat_polymorphic_value<FlatBase> p(std::in_place_type<FlatDerived>, 7);
+  flat_polymorphic_value<FlatBase> q(std::in_place_type<FlatDerived>, 87);
+
+  q = p;
+
+  REQUIRE(q->value() == 7);
+  REQUIRE(q.operator->() != p.operator->());
+
+  q = std::move(p);
+
+  REQUIRE_FALSE(bool(p));
+  REQUIRE(q->value() == 7);
+
+  q = q;
+
+  REQUIRE(q->value() == 7);
+}
+
+TEST_CASE("flat_polymorphic_value destruction",
+          "[flat_polymorphic_value.destructor]") {
+  REQUIRE(FlatDerived::object_count == 0);
+  {
+    flat_polymorphic_value<FlatBase> p(std::in_place_type<FlatDerived>);
+    REQUIRE(FlatDerived::object_count == 1);
+  }
+  REQUIRE(FlatDerived::object_count == 0);
+}
+
+TEST_CASE("make_flat_polymorphic_value",
+          "[flat_polymorphic_value.make_flat_polymorphic_value]") {
+  auto p = make_flat_polymorphic_value<FlatBase, FlatDerived>(7);
+  static_assert(
+      std::is_same<decltype(p), flat_polymorphic_value<FlatBase>>::value, "");
+  REQUIRE(p->value() == 7);
+}
+
+TEST_CASE("flat_polymorphic_value with non-primary base",
+          "[flat_polymorphic_value.multiple_bases]") {
+  // The base subobject is not at offset zero; the dispatch table must apply
+  // the derived-to-base adjustment.
+  auto p = make_flat_polymorphic_value<FlatBaseB, FlatMultiplyDerived>(7);
+
+  REQUIRE(p->b_ == 2);
+
+  flat_polymorphic_value<FlatBaseB> q(p);
+
+  REQUIRE(q->b_ == 2);
+}
+
+TEST_CASE("flat_polymorphic_value swap", "[flat_polymorphic_value.swap]") {
+  flat_polymorphic_value<FlatBase> p(std::in_place_type<FlatDerived>, 7);
+  flat_polymorphic_value<FlatBase> q(std::in_place_type<FlatDerived>, 87);
+
+  swap(p, q);
+
+  REQUIRE(p->value() == 87);
+  REQUIRE(q->value() == 7);
+}
@@ -21,21 +21,252 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #ifndef ISOCPP_P0201_POLYMORPHIC_VALUE_H_INCLUDED
 #define ISOCPP_P0201_POLYMORPHIC_VALUE_H_INCLUDED
 
+#include <atomic>
 #include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #include <exception>
 #include <memory>
+#include <new>
 #include <type_traits>
 #include <typeinfo>
 #include <utility>
 
+#if defined(__has_include)
+#if __has_include(<memory_resource>)
+#include <memory_resource>
+#if defined(__cpp_lib_memory_resource)
+#define ISOCPP_P0201_POLYMORPHIC_VALUE_HAS_MEMORY_RESOURCE 1
+#endif
+#endif
+#endif
+
 #if (__cpp_constexpr >= 202002)
 #define ISOCPP_P0201_CONSTEXPR_CXX20 constexpr
 #else
 #define ISOCPP_P0201_CONSTEXPR_CXX20
 #endif
 
+// P1144-style trivial relocatability. `polymorphic_value` is two pointers and
+// moves by pointer steal, so relocating one with memcpy (and not running the
+// moved-from destructor) is equivalent to move-construction plus destruction.
+#if defined(__has_cpp_attribute)
+#if __has_cpp_attribute(clang::trivially_relocatable)
+#define ISOCPP_P0201_TRIVIALLY_RELOCATABLE [[clang::trivially_relocatable]]
+#endif
+#endif
+#ifndef ISOCPP_P0201_TRIVIALLY_RELOCATABLE
+#define ISOCPP_P0201_TRIVIALLY_RELOCATABLE
+#endif
+
+// Exception configuration. When the translation unit is built without
+// exception support (-fno-exceptions) the unwind paths in this header are
+// compiled out: failures that would have thrown call `std::abort` instead,
+// and the `try_*` factories below report recoverable failures as an empty
+// value rather than by throwing.
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS) || defined(_CPPUNWIND)
+#define ISOCPP_P0201_HAS_EXCEPTIONS 1
+#else
+#define ISOCPP_P0201_HAS_EXCEPTIONS 0
+#endif
+
+#if ISOCPP_P0201_HAS_EXCEPTIONS
+#define ISOCPP_P0201_TRY try
+#define ISOCPP_P0201_CATCH_ALL catch (...)
+#define ISOCPP_P0201_RETHROW throw
+#define ISOCPP_P0201_THROW(exception) throw exception
+#else
+#define ISOCPP_P0201_TRY if (true)
+#define ISOCPP_P0201_CATCH_ALL else if (false)
+#define ISOCPP_P0201_RETHROW std::abort()
+#define ISOCPP_P0201_THROW(exception) std::abort()
+#endif
+
+// Statement form of C++23 [[assume]], with compiler builtins as fallbacks:
+// tells the optimizer a condition holds without evaluating or checking it.
+#if defined(__has_cpp_attribute)
+#if __has_cpp_attribute(assume) >= 202207L
+#define ISOCPP_P0201_ASSUME(expr) [[assume(expr)]]
+#endif
+#endif
+#ifndef ISOCPP_P0201_ASSUME
+#if defined(__clang__)
+#define ISOCPP_P0201_ASSUME(expr) __builtin_assume(expr)
+#elif defined(__GNUC__)
+#define ISOCPP_P0201_ASSUME(expr) \
+  do {                            \
+    if (!(expr)) {                \
+      __builtin_unreachable();    \
+    }                             \
+  } while (0)
+#elif defined(_MSC_VER)
+#define ISOCPP_P0201_ASSUME(expr) __assume(expr)
+#else
+#define ISOCPP_P0201_ASSUME(expr) (void)0
+#endif
+#endif  // ISOCPP_P0201_ASSUME
+
 namespace isocpp_p0201 {
 
+#ifdef ISOCPP_P0201_POLYMORPHIC_VALUE_INSTRUMENTATION
+
+////////////////////////////////////////////////////////////////////////////////
+// Instrumentation, enabled by defining
+// ISOCPP_P0201_POLYMORPHIC_VALUE_INSTRUMENTATION before including this header.
+// Counters are kept per erased type with relaxed atomics so instrumentation
+// can stay enabled in production; a process-wide hook can additionally observe
+// every allocate/clone/destroy event.
+////////////////////////////////////////////////////////////////////////////////
+
+enum class instrumentation_event { allocate, clone, destroy };
+
+// Called with the event and, for allocations, the control-block size in
+// bytes (zero otherwise). Invoked on hot paths: hooks must be cheap and
+// must not construct, copy or destroy any `polymorphic_value`.
+using instrumentation_hook = void (*)(instrumentation_event,
+                                      std::size_t bytes);
+
+struct instrumentation_stats {
+  std::size_t control_block_allocations = 0;
+  std::size_t clone_calls = 0;
+  std::size_t bytes_allocated = 0;
+  std::size_t flattened_conversions = 0;
+};
+
+namespace detail {
+
+inline std::atomic<instrumentation_hook>& instrumentation_hook_slot() {
+  static std::atomic<instrumentation_hook> hook{nullptr};
+  return hook;
+}
+
+inline void invoke_instrumentation_hook(instrumentation_event event,
+                                        std::size_t bytes) {
+  if (instrumentation_hook hook =
+          instrumentation_hook_slot().load(std::memory_order_relaxed)) {
+    hook(event, bytes);
+  }
+}
+
+template <class T>
+struct instrumentation_counters {
+  static std::atomic<std::size_t> control_block_allocations;
+  static std::atomic<std::size_t> clone_calls;
+  static std::atomic<std::size_t> bytes_allocated;
+  static std::atomic<std::size_t> flattened_conversions;
+};
+
+template <class T>
+std::atomic<std::size_t>
+    instrumentation_counters<T>::control_block_allocations{0};
+
+template <class T>
+std::atomic<std::size_t> instrumentation_counters<T>::clone_calls{0};
+
+template <class T>
+std::atomic<std::size_t> instrumentation_counters<T>::bytes_allocated{0};
+
+template <class T>
+std::atomic<std::size_t> instrumentation_counters<T>::flattened_conversions{0};
+
+template <class T>
+void note_control_block_allocation(std::size_t bytes) {
+  instrumentation_counters<T>::control_block_allocations.fetch_add(
+      1, std::memory_order_relaxed);
+  instrumentation_counters<T>::bytes_allocated.fetch_add(
+      bytes, std::memory_order_relaxed);
+  invoke_instrumentation_hook(instrumentation_event::allocate, bytes);
+}
+
+template <class T>
+void note_clone() {
+  instrumentation_counters<T>::clone_calls.fetch_add(1,
+                                                     std::memory_order_relaxed);
+  invoke_instrumentation_hook(instrumentation_event::clone, 0);
+}
+
+template <class T>
+void note_flattened_conversion() {
+  instrumentation_counters<T>::flattened_conversions.fetch_add(
+      1, std::memory_order_relaxed);
+}
+
+template <class T>
+void note_destroy() {
+  invoke_instrumentation_hook(instrumentation_event::destroy, 0);
+}
+
+}  // end namespace detail
+
+// Relaxed-atomic snapshot of the counters for `polymorphic_value<T>`.
+template <class T>
+instrumentation_stats instrumentation_snapshot() {
+  instrumentation_stats stats;
+  stats.control_block_allocations =
+      detail::instrumentation_counters<T>::control_block_allocations.load(
+          std::memory_order_relaxed);
+  stats.clone_calls = detail::instrumentation_counters<T>::clone_calls.load(
+      std::memory_order_relaxed);
+  stats.bytes_allocated =
+      detail::instrumentation_counters<T>::bytes_allocated.load(
+          std::memory_order_relaxed);
+  stats.flattened_conversions =
+      detail::instrumentation_counters<T>::flattened_conversions.load(
+          std::memory_order_relaxed);
+  return stats;
+}
+
+template <class T>
+void reset_instrumentation() {
+  detail::instrumentation_counters<T>::control_block_allocations.store(
+      0, std::memory_order_relaxed);
+  detail::instrumentation_counters<T>::clone_calls.store(
+      0, std::memory_order_relaxed);
+  detail::instrumentation_counters<T>::bytes_allocated.store(
+      0, std::memory_order_relaxed);
+  detail::instrumentation_counters<T>::flattened_conversions.store(
+      0, std::memory_order_relaxed);
+}
+
+// Installs (or, with nullptr, removes) the process-wide event hook.
+inline void set_instrumentation_hook(instrumentation_hook hook) {
+  detail::instrumentation_hook_slot().store(hook, std::memory_order_relaxed);
+}
+
+#else  // ISOCPP_P0201_POLYMORPHIC_VALUE_INSTRUMENTATION
+
+namespace detail {
+
+template <class T>
+constexpr void note_control_block_allocation(std::size_t) {}
+
+template <class T>
+constexpr void note_clone() {}
+
+template <class T>
+constexpr void note_flattened_conversion() {}
+
+template <class T>
+constexpr void note_destroy() {}
+
+}  // end namespace detail
+
+#endif  // ISOCPP_P0201_POLYMORPHIC_VALUE_INSTRUMENTATION
+
+template <class T>
+class ISOCPP_P0201_TRIVIALLY_RELOCATABLE polymorphic_value;
+
+// Payloads whose clone may be a raw byte copy of the control block instead
+// of a copy-constructor call. Defaults to trivial copyability; specializable
+// for user types (in either direction) when the default is wrong.
+template <class T>
+struct is_trivially_clonable : std::is_trivially_copyable<T> {};
+
+template <class T>
+constexpr bool is_trivially_clonable_v = is_trivially_clonable<T>::value;
+
 namespace detail {
 
 ////////////////////////////////////////////////////////////////////////////
@@ -65,9 +296,236 @@ class control_block_deleter {
   }
 };
 
+#ifdef ISOCPP_P0201_POLYMORPHIC_VALUE_USE_CONTROL_BLOCK_POOL
+
+// Thread-local free-list pool for heap-backed control blocks, enabled by
+// defining ISOCPP_P0201_POLYMORPHIC_VALUE_USE_CONTROL_BLOCK_POOL before
+// including this header. Freed control blocks are binned by size class and
+// reused by subsequent allocations on the same thread, turning clone/destroy
+// churn on hot types into a pointer pop and push. Blocks larger than the
+// largest bin fall through to global operator new/delete.
+class control_block_pool {
+  struct free_node {
+    free_node* next;
+  };
+
+  static constexpr std::size_t bin_granularity = 64;
+  static constexpr std::size_t num_bins = 16;
+  static constexpr std::size_t max_pooled_size = bin_granularity * num_bins;
+
+  free_node* bins_[num_bins] = {};
+
+  static constexpr std::size_t bin_index(std::size_t size) {
+    return (size + bin_granularity - 1) / bin_granularity - 1;
+  }
+
+  static constexpr std::size_t bin_size(std::size_t size) {
+    return (bin_index(size) + 1) * bin_granularity;
+  }
+
+ public:
+  ~control_block_pool() { flush(); }
+
+  void* allocate(std::size_t size) {
+    if (size == 0 || size > max_pooled_size) {
+      return ::operator new(size);
+    }
+    free_node*& head = bins_[bin_index(size)];
+    if (head) {
+      free_node* node = head;
+      head = node->next;
+      return node;
+    }
+    return ::operator new(bin_size(size));
+  }
+
+  void deallocate(void* p, std::size_t size) noexcept {
+    if (size == 0 || size > max_pooled_size) {
+      ::operator delete(p);
+      return;
+    }
+    free_node*& head = bins_[bin_index(size)];
+    auto* node = static_cast<free_node*>(p);
+    node->next = head;
+    head = node;
+  }
+
+  // Returns all pooled memory to the global allocator.
+  void flush() noexcept {
+    for (free_node*& head : bins_) {
+      while (head) {
+        free_node* next = head->next;
+        ::operator delete(head);
+        head = next;
+      }
+    }
+  }
+
+  static control_block_pool& instance() {
+    thread_local control_block_pool pool;
+    return pool;
+  }
+};
+
+#endif  // ISOCPP_P0201_POLYMORPHIC_VALUE_USE_CONTROL_BLOCK_POOL
+
+// Header of a slab holding arena-cloned control blocks, reference-counted by
+// the blocks constructed inside it (plus the creating `clone_n` call). The
+// slab is freed when the last reference is released.
+struct bulk_arena_header {
+  std::atomic<std::size_t> refs{1};
+
+  void retain() noexcept { refs.fetch_add(1, std::memory_order_relaxed); }
+
+  static void release(bulk_arena_header* h) noexcept {
+    if (h->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      h->~bulk_arena_header();
+      ::operator delete(h);
+    }
+  }
+};
+
+// Allocation family of a replacement control block (see
+// `polymorphic_value::emplace`). An allocator-backed block cannot name the
+// replacement's type (it depends on the emplaced `U`) and the replacement
+// cannot name the allocator, so the family object -- carrying a copy of the
+// allocator in the same allocation as the replacement -- bridges the two:
+// it frees the replacement's storage and hands out same-family storage for
+// the replacement's clones and later replacements.
+class replacement_family {
+ public:
+  virtual ~replacement_family() = default;
+
+  // Storage for another `size`-byte block of this family, returned in
+  // `storage` with a fresh family object co-located after it.
+  virtual replacement_family* reallocate(std::size_t size, void*& storage) = 0;
+
+  // Frees `storage` (and this object, which lives inside it).
+  virtual void dispose(void* storage, std::size_t size) noexcept = 0;
+};
+
+// Type-erased view of a control block, independent of the interface type `T`.
+// Conversion flattening (see `flattened_control_block`) owns and clones the
+// underlying block through this interface so conversion depth never shows up
+// in dereference or clone cost.
+class erased_control_block {
+ public:
+  ISOCPP_P0201_CONSTEXPR_CXX20 virtual ~erased_control_block() = default;
+
+  ISOCPP_P0201_CONSTEXPR_CXX20 virtual void destroy() noexcept { delete this; }
+
+  // The address of the stored (most-derived) object.
+  virtual void* object_address() noexcept = 0;
+
+  // A clone of the underlying, non-delegating block.
+  virtual erased_control_block* clone_erased() const = 0;
+
+  // Raw bytes allocated "from the same place" as this block, so conversion
+  // wrappers built around it (and their clones) follow the block's
+  // allocator instead of silently reverting to the global heap. Pure here:
+  // the defaults live in `control_block<T>` because their bodies depend on
+  // the pool configuration macro, and a definition that varies with a macro
+  // must stay in template code that differently-configured translation
+  // units instantiate for their own (local) types rather than in a
+  // non-template class they would all define differently.
+  virtual void* allocate_bytes(std::size_t size) = 0;
+
+  virtual void deallocate_bytes(void* p, std::size_t size) noexcept = 0;
+
+  // Identity key for the stored payload type, shared by every block kind
+  // that constructs its `U` inline, so `visit` can recognize the payload
+  // however the value was created. On the erased interface so conversion
+  // wrappers can forward to the block they wrap. Blocks that merely hold a
+  // pointer (whose pointee may be more derived than `U`) return nullptr.
+  virtual const void* payload_key() const noexcept { return nullptr; }
+
+  // Transfers ownership of a delegated-to block, or returns nullptr for
+  // blocks that store their object directly.
+  virtual erased_control_block* release_delegate() noexcept { return nullptr; }
+};
+
+// True for alignments that plain `operator new` (and the pool) cannot
+// guarantee: over-aligned payloads such as `alignas(64)` SIMD state make the
+// whole control block over-aligned and must go through aligned allocation.
+constexpr bool is_over_aligned(std::size_t align) noexcept {
+#ifdef __cpp_aligned_new
+  return align > __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+#else
+  return false;
+#endif
+}
+
 template <class T>
-struct control_block {
-  ISOCPP_P0201_CONSTEXPR_CXX20 virtual ~control_block() = default;
+struct control_block : erased_control_block {
+#ifdef ISOCPP_P0201_POLYMORPHIC_VALUE_USE_CONTROL_BLOCK_POOL
+  static void* operator new(std::size_t size) {
+    return control_block_pool::instance().allocate(size);
+  }
+
+  static void operator delete(void* p, std::size_t size) noexcept {
+    control_block_pool::instance().deallocate(p, size);
+  }
+
+#ifdef __cpp_aligned_new
+  // Over-aligned blocks bypass the pool, whose slots only guarantee
+  // alignof(std::max_align_t).
+  static void* operator new(std::size_t size, std::align_val_t align) {
+    return ::operator new(size, align);
+  }
+
+  static void operator delete(void* p, std::size_t size,
+                              std::align_val_t align) noexcept {
+    ::operator delete(p, size, align);
+  }
+#endif  // __cpp_aligned_new
+#endif  // ISOCPP_P0201_POLYMORPHIC_VALUE_USE_CONTROL_BLOCK_POOL
+
+  // Raw storage for a block of this family, aligned to `align`; from the
+  // pool when it is enabled and the alignment is ordinary. Matches the
+  // deallocation performed by `delete this` on the constructed block.
+  static void* allocate_storage(std::size_t size, std::size_t align) {
+#ifdef __cpp_aligned_new
+    if (is_over_aligned(align)) {
+      return ::operator new(size, std::align_val_t(align));
+    }
+#endif  // __cpp_aligned_new
+    (void)align;
+#ifdef ISOCPP_P0201_POLYMORPHIC_VALUE_USE_CONTROL_BLOCK_POOL
+    return control_block_pool::instance().allocate(size);
+#else
+    return ::operator new(size);
+#endif  // ISOCPP_P0201_POLYMORPHIC_VALUE_USE_CONTROL_BLOCK_POOL
+  }
+
+  // Frees raw block storage obtained from `try_reuse_storage` if
+  // constructing the replacement block throws.
+  static void deallocate_storage(void* p, std::size_t size,
+                                 std::size_t align) noexcept {
+#ifdef __cpp_aligned_new
+    if (is_over_aligned(align)) {
+      ::operator delete(p, size, std::align_val_t(align));
+      return;
+    }
+#endif  // __cpp_aligned_new
+    (void)align;
+#ifdef ISOCPP_P0201_POLYMORPHIC_VALUE_USE_CONTROL_BLOCK_POOL
+    control_block_pool::instance().deallocate(p, size);
+#else
+    (void)size;
+    ::operator delete(p);
+#endif  // ISOCPP_P0201_POLYMORPHIC_VALUE_USE_CONTROL_BLOCK_POOL
+  }
+
+  // Default byte allocation from this block's family (see
+  // `erased_control_block::allocate_bytes`): the pool when it is enabled,
+  // the global heap otherwise. Allocator-backed blocks override both.
+  void* allocate_bytes(std::size_t size) override {
+    return allocate_storage(size, alignof(std::max_align_t));
+  }
+
+  void deallocate_bytes(void* p, std::size_t size) noexcept override {
+    deallocate_storage(p, size, alignof(std::max_align_t));
+  }
 
   ISOCPP_P0201_CONSTEXPR_CXX20 virtual std::unique_ptr<control_block,
                                                        control_block_deleter>
@@ -75,11 +533,65 @@ struct control_block {
 
   ISOCPP_P0201_CONSTEXPR_CXX20 virtual T* ptr() = 0;
 
-  ISOCPP_P0201_CONSTEXPR_CXX20 virtual void destroy() noexcept { delete this; }
+  erased_control_block* clone_erased() const override {
+    return clone().release();
+  }
+
+  // Bulk-clone support (see isocpp_p0201::clone_n). Blocks that can clone
+  // into caller-provided storage report their arena footprint from
+  // `clone_sizeof` and construct the clone with `clone_into`; others return 0
+  // and are cloned with the allocating `clone()`.
+  virtual std::size_t clone_sizeof() const noexcept { return 0; }
+
+  virtual control_block* clone_into(void*, bulk_arena_header*) const {
+    return nullptr;
+  }
+
+  // Identity key for the block's concrete type, used (instead of RTTI) to
+  // pair blocks for in-place assignment. Blocks that do not participate
+  // return nullptr.
+  virtual const void* block_type_key() const noexcept { return nullptr; }
+
+  // In-place copy assignment support for `polymorphic_value::operator=`:
+  // if this block holds the same concrete payload as `source` and the
+  // payload is copy-assignable, assigns it in place and returns true,
+  // avoiding the clone allocation and the deallocation of this block.
+  virtual bool assign_from(const control_block&) { return false; }
+
+  // Storage reuse for `polymorphic_value::emplace`. If this block's
+  // allocation can hold a replacement block of exactly `size` bytes with
+  // alignment `align`, destroys the block in place (without deallocating)
+  // and returns the raw storage; otherwise returns nullptr and the block is
+  // untouched. Sizes must match exactly so later sized or pooled
+  // deallocation of the replacement stays consistent with the original
+  // allocation.
+  virtual void* try_reuse_storage(std::size_t, std::size_t) noexcept {
+    return nullptr;
+  }
+
+  // Replacement storage for `polymorphic_value::emplace` when this block's
+  // own storage cannot be reused. The default returns nullptr and the
+  // replacement comes from the global family; allocator-backed blocks
+  // return same-family storage (with its family object, see
+  // `replacement_family`) so emplacing into an allocated value keeps its
+  // allocator.
+  virtual replacement_family* allocate_replacement(std::size_t, void*&) {
+    return nullptr;
+  }
 };
 
+template <class T, class U>
+class arena_direct_control_block;
+
+// One address per payload type, independent of the block kind storing it.
+template <class U>
+const void* payload_type_key() noexcept {
+  static const char key = 0;
+  return &key;
+}
+
 template <class T, class U = T>
-class direct_control_block : public control_block<T> {
+class direct_control_block final : public control_block<T> {
   static_assert(!std::is_reference<U>::value, "");
   U u_;
 
@@ -91,15 +603,117 @@ class direct_control_block : public control_block<T> {
   ISOCPP_P0201_CONSTEXPR_CXX20
   std::unique_ptr<control_block<T>, control_block_deleter> clone()
       const override {
+    // Trivially clonable payloads are cloned by copying the whole block --
+    // vtable pointer included, which is identical for the same most-derived
+    // block type -- letting bulk copies of POD-like payloads compile down
+    // to memcpy instead of a constructor call per object.
+#if defined(__cpp_lib_is_constant_evaluated)
+    if (!std::is_constant_evaluated())
+#endif
+    {
+      if constexpr (is_trivially_clonable<U>::value) {
+        void* raw = control_block<T>::allocate_storage(
+            sizeof(direct_control_block), alignof(direct_control_block));
+        std::memcpy(raw, this, sizeof(direct_control_block));
+        return std::unique_ptr<direct_control_block, control_block_deleter>(
+            static_cast<direct_control_block*>(raw));
+      }
+    }
     return std::unique_ptr<direct_control_block, control_block_deleter>(
         new direct_control_block(*this));
   }
 
   ISOCPP_P0201_CONSTEXPR_CXX20 T* ptr() override { return std::addressof(u_); }
+
+  void* object_address() noexcept override { return std::addressof(u_); }
+
+  std::size_t clone_sizeof() const noexcept override {
+    return alignof(arena_direct_control_block<T, U>) <=
+                   alignof(std::max_align_t)
+               ? sizeof(arena_direct_control_block<T, U>)
+               : 0;
+  }
+
+  void* try_reuse_storage(std::size_t size, std::size_t align) noexcept
+      override {
+    // The replacement must also use the same allocation function family:
+    // handing storage from an aligned `operator new` to a block whose
+    // `delete this` calls the unaligned one would mismatch them.
+    if (size != sizeof(direct_control_block) ||
+        align > alignof(direct_control_block) ||
+        is_over_aligned(align) !=
+            is_over_aligned(alignof(direct_control_block))) {
+      return nullptr;
+    }
+    this->~direct_control_block();
+    return this;
+  }
+
+  control_block<T>* clone_into(void* buffer,
+                               bulk_arena_header* arena) const override {
+    return ::new (buffer) arena_direct_control_block<T, U>(u_, arena);
+  }
+
+  static const void* type_key() noexcept {
+    static const char key = 0;
+    return &key;
+  }
+
+  const void* block_type_key() const noexcept override { return type_key(); }
+
+  const void* payload_key() const noexcept override {
+    return payload_type_key<U>();
+  }
+
+  bool assign_from(const control_block<T>& source) override {
+    if constexpr (std::is_copy_assignable<U>::value) {
+      if (source.block_type_key() == type_key()) {
+        u_ = static_cast<const direct_control_block&>(source).u_;
+        return true;
+      }
+    }
+    return false;
+  }
+};
+
+// A direct control block that lives inside a `clone_n` slab rather than its
+// own allocation. Destruction runs in place and releases the slab reference;
+// further clones go back to ordinary heap blocks.
+template <class T, class U>
+class arena_direct_control_block final : public control_block<T> {
+  U u_;
+  bulk_arena_header* arena_;
+
+ public:
+  explicit arena_direct_control_block(const U& u, bulk_arena_header* arena)
+      : u_(u), arena_(arena) {}
+
+  explicit arena_direct_control_block(U&& u, bulk_arena_header* arena)
+      : u_(std::move(u)), arena_(arena) {}
+
+  std::unique_ptr<control_block<T>, control_block_deleter> clone()
+      const override {
+    return std::unique_ptr<direct_control_block<T, U>, control_block_deleter>(
+        new direct_control_block<T, U>(u_));
+  }
+
+  T* ptr() override { return std::addressof(u_); }
+
+  void* object_address() noexcept override { return std::addressof(u_); }
+
+  const void* payload_key() const noexcept override {
+    return payload_type_key<U>();
+  }
+
+  void destroy() noexcept override {
+    bulk_arena_header* arena = arena_;
+    this->~arena_direct_control_block();
+    bulk_arena_header::release(arena);
+  }
 };
 
 template <class T, class U, class C, class D>
-class pointer_control_block : public control_block<T>, public C {
+class pointer_control_block final : public control_block<T>, public C {
   std::unique_ptr<U, D> p_;
 
  public:
@@ -120,25 +734,166 @@ class pointer_control_block : public control_block<T>, public C {
   }
 
   ISOCPP_P0201_CONSTEXPR_CXX20 T* ptr() override { return p_.get(); }
+
+  void* object_address() noexcept override { return p_.get(); }
 };
 
-template <class T, class U>
-class delegating_control_block : public control_block<T> {
-  std::unique_ptr<control_block<U>, control_block_deleter> delegate_;
+// Control block for an adopted `std::unique_ptr<U, D>`. Holds the deleter and
+// bookkeeping in a single metadata-only allocation; copies are made with `U`'s
+// copy constructor so `clone` allocates the copy and its metadata together in
+// one `direct_control_block`.
+template <class T, class U, class D>
+class unique_pointer_control_block final : public control_block<T> {
+  std::unique_ptr<U, D> p_;
 
  public:
-  constexpr explicit delegating_control_block(
-      std::unique_ptr<control_block<U>, control_block_deleter> b)
-      : delegate_(std::move(b)) {}
+  constexpr explicit unique_pointer_control_block(std::unique_ptr<U, D> p)
+      : p_(std::move(p)) {}
 
   ISOCPP_P0201_CONSTEXPR_CXX20
   std::unique_ptr<control_block<T>, control_block_deleter> clone()
       const override {
-    return std::unique_ptr<delegating_control_block, control_block_deleter>(
-        new delegating_control_block(delegate_->clone()));
+    assert(p_);
+    return std::unique_ptr<direct_control_block<T, U>, control_block_deleter>(
+        new direct_control_block<T, U>(*p_));
+  }
+
+  ISOCPP_P0201_CONSTEXPR_CXX20 T* ptr() override { return p_.get(); }
+
+  void* object_address() noexcept override { return p_.get(); }
+};
+
+// Control block produced by the converting constructors. Owns the source
+// block through the type-erased interface and converts to `T` with a byte
+// offset precomputed at construction, so `ptr()` and `clone()` stay at one
+// indirection however many base conversions the value has been through. The
+// offset from the stored complete object to its `T` subobject is a constant
+// of the object's dynamic type (also with virtual bases), so it remains valid
+// for clones.
+template <class T>
+class flattened_control_block final : public control_block<T> {
+  std::unique_ptr<erased_control_block, control_block_deleter> inner_;
+  // Provider of this wrapper's storage (the inner block at construction).
+  // Kept separately because `release_delegate` may steal `inner_` just
+  // before the wrapper is destroyed; the caller keeps the source block
+  // alive through that sequence.
+  erased_control_block* bytes_source_;
+  void* object_;
+  std::ptrdiff_t offset_;
+
+  explicit flattened_control_block(
+      std::unique_ptr<erased_control_block, control_block_deleter> inner,
+      void* object, std::ptrdiff_t offset)
+      : inner_(std::move(inner)),
+        bytes_source_(inner_.get()),
+        object_(object),
+        offset_(offset) {}
+
+ public:
+  // Wrappers live in storage provided by the wrapped block, so a value
+  // built with allocate_polymorphic_value keeps using its allocator after
+  // conversion, for the wrapper and all downstream clones.
+  static flattened_control_block* create(
+      std::unique_ptr<erased_control_block, control_block_deleter> inner,
+      void* object, std::ptrdiff_t offset) {
+    void* raw = inner->allocate_bytes(sizeof(flattened_control_block));
+    return ::new (raw)
+        flattened_control_block(std::move(inner), object, offset);
+  }
+
+  std::unique_ptr<control_block<T>, control_block_deleter> clone()
+      const override {
+    std::unique_ptr<erased_control_block, control_block_deleter> cloned(
+        inner_->clone_erased());
+    void* object = cloned->object_address();
+    return std::unique_ptr<flattened_control_block, control_block_deleter>(
+        create(std::move(cloned), object, offset_));
+  }
+
+  void destroy() noexcept override {
+    std::unique_ptr<erased_control_block, control_block_deleter> inner =
+        std::move(inner_);
+    erased_control_block* source = bytes_source_;
+    this->~flattened_control_block();
+    source->deallocate_bytes(this, sizeof(flattened_control_block));
+  }
+
+  T* ptr() override {
+    return reinterpret_cast<T*>(static_cast<char*>(object_) + offset_);
+  }
+
+  void* object_address() noexcept override { return object_; }
+
+  // Forwarded so `visit` keeps seeing the leaf payload after conversion.
+  const void* payload_key() const noexcept override {
+    return inner_->payload_key();
+  }
+
+  erased_control_block* clone_erased() const override {
+    return inner_->clone_erased();
+  }
+
+  erased_control_block* release_delegate() noexcept override {
+    return inner_.release();
+  }
+};
+
+// Conversion wrapper co-located with its wrapped block: the copy-converting
+// constructor clones a direct source block and builds the wrapper around it
+// in one refcounted slab, so viewing a derived value as a base costs a
+// single allocation. Wrapper and inner block each hold a slab reference,
+// letting either outlive the other after `release_delegate`.
+template <class T>
+class arena_flattened_control_block final : public control_block<T> {
+  std::unique_ptr<erased_control_block, control_block_deleter> inner_;
+  bulk_arena_header* arena_;
+  void* object_;
+  std::ptrdiff_t offset_;
+
+ public:
+  explicit arena_flattened_control_block(erased_control_block* inner,
+                                         bulk_arena_header* arena,
+                                         void* object, std::ptrdiff_t offset)
+      : inner_(inner), arena_(arena), object_(object), offset_(offset) {}
+
+  std::unique_ptr<control_block<T>, control_block_deleter> clone()
+      const override {
+    std::unique_ptr<erased_control_block, control_block_deleter> cloned(
+        inner_->clone_erased());
+    void* object = cloned->object_address();
+    return std::unique_ptr<flattened_control_block<T>, control_block_deleter>(
+        flattened_control_block<T>::create(std::move(cloned), object,
+                                           offset_));
+  }
+
+  void destroy() noexcept override {
+    std::unique_ptr<erased_control_block, control_block_deleter> inner =
+        std::move(inner_);
+    bulk_arena_header* arena = arena_;
+    this->~arena_flattened_control_block();
+    // The inner block (when not stolen) lives in the slab too; destroy it
+    // before dropping the reference that keeps the slab alive.
+    inner.reset();
+    bulk_arena_header::release(arena);
   }
 
-  ISOCPP_P0201_CONSTEXPR_CXX20 T* ptr() override { return delegate_->ptr(); }
+  T* ptr() override {
+    return reinterpret_cast<T*>(static_cast<char*>(object_) + offset_);
+  }
+
+  void* object_address() noexcept override { return object_; }
+
+  const void* payload_key() const noexcept override {
+    return inner_->payload_key();
+  }
+
+  erased_control_block* clone_erased() const override {
+    return inner_->clone_erased();
+  }
+
+  erased_control_block* release_delegate() noexcept override {
+    return inner_.release();
+  }
 };
 
 template <typename A>
@@ -150,24 +905,103 @@ struct allocator_wrapper : A {
   }
 };
 
+// The rebound allocator must honor the value type's (possibly extended)
+// alignment, as `std::allocator` does since C++17.
 template <typename T, typename A, typename... Args>
-ISOCPP_P0201_CONSTEXPR_CXX20 T* allocate_object(A& a, Args&&... args) {
+ISOCPP_P0201_CONSTEXPR_CXX20 T* allocate_object(const A& a, Args&&... args) {
   using t_allocator =
       typename std::allocator_traits<A>::template rebind_alloc<T>;
   using t_traits = std::allocator_traits<t_allocator>;
   t_allocator t_alloc(a);
   T* mem = t_traits::allocate(t_alloc, 1);
-  try {
+  ISOCPP_P0201_TRY {
     t_traits::construct(t_alloc, mem, std::forward<Args>(args)...);
     return mem;
-  } catch (...) {
+  }
+  ISOCPP_P0201_CATCH_ALL {
     t_traits::deallocate(t_alloc, mem, 1);
-    throw;
+    ISOCPP_P0201_RETHROW;
+  }
+}
+
+// Uses-allocator construction of a payload, as `allocator_traits::construct`
+// would perform it: allocator-aware `U`s receive the allocator rebound to
+// `U` (leading or trailing, per their constructors) and other types are
+// constructed from the arguments alone. Returned by value so guaranteed
+// elision builds the result directly in its final location.
+template <typename U, typename A, typename... Ts>
+constexpr U construct_with_allocator(const A& a, Ts&&... ts) {
+  using u_allocator =
+      typename std::allocator_traits<A>::template rebind_alloc<U>;
+  u_allocator u_alloc(a);
+  if constexpr (std::uses_allocator<U, u_allocator>::value &&
+                std::is_constructible<U, std::allocator_arg_t,
+                                      const u_allocator&, Ts...>::value) {
+    return U(std::allocator_arg, u_alloc, std::forward<Ts>(ts)...);
+  } else if constexpr (std::uses_allocator<U, u_allocator>::value) {
+    return U(std::forward<Ts>(ts)..., u_alloc);
+  } else {
+    return U(std::forward<Ts>(ts)...);
+  }
+}
+
+template <typename A>
+void* allocate_bytes_with(const A& a, std::size_t size) {
+  using byte_allocator =
+      typename std::allocator_traits<A>::template rebind_alloc<unsigned char>;
+  byte_allocator b_alloc(a);
+  return std::allocator_traits<byte_allocator>::allocate(b_alloc, size);
+}
+
+template <typename A>
+void deallocate_bytes_with(const A& a, void* p, std::size_t size) noexcept {
+  using byte_allocator =
+      typename std::allocator_traits<A>::template rebind_alloc<unsigned char>;
+  byte_allocator b_alloc(a);
+  std::allocator_traits<byte_allocator>::deallocate(
+      b_alloc, static_cast<unsigned char*>(p), size);
+}
+
+// `replacement_family` carrying allocator `A`, co-located after the
+// replacement block it serves in a single allocation from `A`.
+template <typename A>
+class replacement_family_impl final : public replacement_family {
+  A a_;
+
+  // The family object sits after the block storage, padded up to its own
+  // alignment; `dispose` recomputes the same layout from the block size.
+  static constexpr std::size_t family_offset(std::size_t size) {
+    return (size + alignof(replacement_family_impl) - 1) /
+           alignof(replacement_family_impl) * alignof(replacement_family_impl);
+  }
+
+ public:
+  explicit replacement_family_impl(const A& a) : a_(a) {}
+
+  static replacement_family_impl* create(const A& a, std::size_t size,
+                                         void*& storage) {
+    const std::size_t offset = family_offset(size);
+    void* raw =
+        allocate_bytes_with(a, offset + sizeof(replacement_family_impl));
+    storage = raw;
+    return ::new (static_cast<char*>(raw) + offset)
+        replacement_family_impl(a);
+  }
+
+  replacement_family* reallocate(std::size_t size, void*& storage) override {
+    return create(a_, size, storage);
   }
-}
+
+  void dispose(void* storage, std::size_t size) noexcept override {
+    A a(std::move(a_));
+    this->~replacement_family_impl();
+    deallocate_bytes_with(a, storage,
+                          family_offset(size) + sizeof(replacement_family_impl));
+  }
+};
 
 template <typename T, typename A>
-constexpr void deallocate_object(A& a, T* p) {
+constexpr void deallocate_object(const A& a, T* p) {
   using t_allocator =
       typename std::allocator_traits<A>::template rebind_alloc<T>;
   using t_traits = std::allocator_traits<t_allocator>;
@@ -177,8 +1011,8 @@ constexpr void deallocate_object(A& a, T* p) {
 }
 
 template <class T, class U, class A>
-class allocated_pointer_control_block : public control_block<T>,
-                                        allocator_wrapper<A> {
+class allocated_pointer_control_block final : public control_block<T>,
+                                              allocator_wrapper<A> {
   U* p_;
 
  public:
@@ -195,25 +1029,181 @@ class allocated_pointer_control_block : public control_block<T>,
     assert(p_);
 
     auto* cloned_ptr = detail::allocate_object<U>(this->get_allocator(), *p_);
-    try {
+    ISOCPP_P0201_TRY {
       auto* new_cb = detail::allocate_object<allocated_pointer_control_block>(
           this->get_allocator(), cloned_ptr, this->get_allocator());
       return std::unique_ptr<control_block<T>, control_block_deleter>(new_cb);
-    } catch (...) {
+    }
+    ISOCPP_P0201_CATCH_ALL {
       detail::deallocate_object(this->get_allocator(), cloned_ptr);
-      throw;
+      ISOCPP_P0201_RETHROW;
     }
   }
 
   ISOCPP_P0201_CONSTEXPR_CXX20 T* ptr() override { return p_; }
 
+  void* object_address() noexcept override { return p_; }
+
+  void* allocate_bytes(std::size_t size) override {
+    return detail::allocate_bytes_with(this->get_allocator(), size);
+  }
+
+  void deallocate_bytes(void* p, std::size_t size) noexcept override {
+    detail::deallocate_bytes_with(this->get_allocator(), p, size);
+  }
+
+  replacement_family* allocate_replacement(std::size_t size,
+                                           void*& storage) override {
+    return replacement_family_impl<A>::create(this->get_allocator(), size,
+                                              storage);
+  }
+
+  ISOCPP_P0201_CONSTEXPR_CXX20 void destroy() noexcept override {
+    detail::deallocate_object(this->get_allocator(), this);
+  }
+};
+
+template <class T, class U, class A>
+class allocated_direct_control_block final : public control_block<T>,
+                                             allocator_wrapper<A> {
+  static_assert(!std::is_reference<U>::value, "");
+  U u_;
+
+ public:
+  template <class... Ts>
+  constexpr explicit allocated_direct_control_block(A a, Ts&&... ts)
+      : allocator_wrapper<A>(a),
+        u_(detail::construct_with_allocator<U>(a, std::forward<Ts>(ts)...)) {}
+
+  ISOCPP_P0201_CONSTEXPR_CXX20
+  std::unique_ptr<control_block<T>, control_block_deleter> clone()
+      const override {
+    auto* new_cb =
+        detail::allocate_object<allocated_direct_control_block>(
+            this->get_allocator(), this->get_allocator(), u_);
+    return std::unique_ptr<control_block<T>, control_block_deleter>(new_cb);
+  }
+
+  ISOCPP_P0201_CONSTEXPR_CXX20 T* ptr() override { return std::addressof(u_); }
+
+  void* object_address() noexcept override { return std::addressof(u_); }
+
+  const void* payload_key() const noexcept override {
+    return payload_type_key<U>();
+  }
+
+  void* allocate_bytes(std::size_t size) override {
+    return detail::allocate_bytes_with(this->get_allocator(), size);
+  }
+
+  void deallocate_bytes(void* p, std::size_t size) noexcept override {
+    detail::deallocate_bytes_with(this->get_allocator(), p, size);
+  }
+
+  replacement_family* allocate_replacement(std::size_t size,
+                                           void*& storage) override {
+    return replacement_family_impl<A>::create(this->get_allocator(), size,
+                                              storage);
+  }
+
   ISOCPP_P0201_CONSTEXPR_CXX20 void destroy() noexcept override {
     detail::deallocate_object(this->get_allocator(), this);
   }
 };
 
+// A direct control block living in allocator-provided replacement storage
+// (see `replacement_family`). Built by `polymorphic_value::emplace` when the
+// block it replaces was allocator-backed; clones and later replacements draw
+// storage from the co-located family object, so the value never silently
+// reverts to the global heap.
+template <class T, class U>
+class replaced_direct_control_block final : public control_block<T> {
+  static_assert(!std::is_reference<U>::value, "");
+  U u_;
+  replacement_family* family_;
+
+ public:
+  template <class... Ts>
+  explicit replaced_direct_control_block(replacement_family* family,
+                                         Ts&&... ts)
+      : u_(U(std::forward<Ts>(ts)...)), family_(family) {}
+
+  std::unique_ptr<control_block<T>, control_block_deleter> clone()
+      const override {
+    void* storage = nullptr;
+    replacement_family* family =
+        family_->reallocate(sizeof(replaced_direct_control_block), storage);
+    ISOCPP_P0201_TRY {
+      return std::unique_ptr<replaced_direct_control_block,
+                             control_block_deleter>(
+          ::new (storage) replaced_direct_control_block(family, u_));
+    }
+    ISOCPP_P0201_CATCH_ALL {
+      family->dispose(storage, sizeof(replaced_direct_control_block));
+      ISOCPP_P0201_RETHROW;
+    }
+  }
+
+  T* ptr() override { return std::addressof(u_); }
+
+  void* object_address() noexcept override { return std::addressof(u_); }
+
+  const void* payload_key() const noexcept override {
+    return payload_type_key<U>();
+  }
+
+  static const void* type_key() noexcept {
+    static const char key = 0;
+    return &key;
+  }
+
+  const void* block_type_key() const noexcept override { return type_key(); }
+
+  bool assign_from(const control_block<T>& source) override {
+    if constexpr (std::is_copy_assignable<U>::value) {
+      if (source.block_type_key() == type_key()) {
+        u_ = static_cast<const replaced_direct_control_block&>(source).u_;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  replacement_family* allocate_replacement(std::size_t size,
+                                           void*& storage) override {
+    return family_->reallocate(size, storage);
+  }
+
+  void destroy() noexcept override {
+    replacement_family* family = family_;
+    this->~replaced_direct_control_block();
+    family->dispose(this, sizeof(replaced_direct_control_block));
+  }
+};
+
+// Internal factory for modules that build control blocks themselves (bulk
+// loaders, serialization): wraps a ready-made block in a `polymorphic_value`.
+// Defined after the class; declared here so the class can befriend it.
+template <class T>
+polymorphic_value<T> adopt_control_block(control_block<T>* cb);
+
+// Internal accessor for `visit`; defined after the class.
+template <class T>
+const control_block<T>* get_control_block(
+    const polymorphic_value<T>& p) noexcept;
+
 }  // end namespace detail
 
+#ifdef ISOCPP_P0201_POLYMORPHIC_VALUE_USE_CONTROL_BLOCK_POOL
+
+// Returns the calling thread's pooled control-block memory to the global
+// allocator.
+inline void flush_control_block_pool() noexcept {
+  detail::control_block_pool::instance().flush();
+}
+
+#endif  // ISOCPP_P0201_POLYMORPHIC_VALUE_USE_CONTROL_BLOCK_POOL
+
 template <class T>
 struct default_copy {
   using deleter_type = std::default_delete<T>;
@@ -233,8 +1223,70 @@ class bad_polymorphic_value_construction : public std::exception {
   }
 };
 
+//
+// Type tags
+//
+// The pointer and allocator constructors guard against slicing by comparing
+// the dynamic type of the adopted object with the static type of the
+// pointer. By default that is a `typeid` comparison. Registering a type tag
+// replaces it with a single-word compare against the vtable pointer — the
+// word the first virtual call loads anyway — and keeps the
+// `bad_polymorphic_value_construction` guarantee in builds where RTTI is
+// disabled.
+//
+
+namespace detail {
+
+template <class U>
+std::atomic<std::uintptr_t>& type_tag_slot() noexcept {
+  static std::atomic<std::uintptr_t> tag{0};
+  return tag;
+}
+
+// The first word of a polymorphic object is its vtable pointer; distinct
+// dynamic types have distinct vtables, so the word identifies the type.
+inline std::uintptr_t vptr_word(const void* p) noexcept {
+  std::uintptr_t word;
+  std::memcpy(&word, p, sizeof(word));
+  return word;
+}
+
+// Returns true when the dynamic type of `*u` is known to differ from `U`.
+// A registered tag reduces the check to one integer compare; otherwise fall
+// back to `typeid` where RTTI is available, and accept the pointer where it
+// is not.
+template <class U>
+bool adopted_type_mismatch(const U* u) noexcept {
+  if constexpr (std::is_polymorphic<U>::value) {
+    const std::uintptr_t tag =
+        type_tag_slot<U>().load(std::memory_order_relaxed);
+    if (tag != 0) {
+      return vptr_word(u) != tag;
+    }
+  }
+#ifndef ISOCPP_P0201_POLYMORPHIC_VALUE_NO_RTTI
+  return typeid(*u) != typeid(U);
+#else
+  (void)u;
+  return false;
+#endif
+}
+
+}  // end namespace detail
+
+// Registers the type tag for `U` from an exemplar object whose dynamic type
+// is exactly `U`. Register tags at startup, before concurrent adoption
+// begins.
+template <class U>
+void register_type_tag(const U& exemplar) noexcept {
+  static_assert(std::is_polymorphic<U>::value,
+                "type tags identify dynamic types");
+  detail::type_tag_slot<U>().store(
+      detail::vptr_word(std::addressof(exemplar)), std::memory_order_relaxed);
+}
+
 template <class T>
-class polymorphic_value;
+class ISOCPP_P0201_TRIVIALLY_RELOCATABLE polymorphic_value;
 
 template <class T>
 struct is_polymorphic_value : std::false_type {};
@@ -242,12 +1294,29 @@ struct is_polymorphic_value : std::false_type {};
 template <class T>
 struct is_polymorphic_value<polymorphic_value<T>> : std::true_type {};
 
+// P1144-style trait: trivially copyable types are trivially relocatable, and
+// `polymorphic_value` opts in explicitly. Specializable for user types.
+template <class T>
+struct is_trivially_relocatable : std::is_trivially_copyable<T> {};
+
+template <class T>
+struct is_trivially_relocatable<polymorphic_value<T>> : std::true_type {};
+
+template <class T>
+constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<T>::value;
+
 ////////////////////////////////////////////////////////////////////////////////
 // `polymorphic_value` class definition
 ////////////////////////////////////////////////////////////////////////////////
 
+// Alignment guarantee: the stored object always sits at an address aligned
+// to the alignment of its concrete type. Control-block storage is obtained
+// with aligned `operator new` (bypassing the block pool) whenever the
+// payload's alignment exceeds what plain allocation provides, on every
+// creation and clone path, so over-aligned payloads such as `alignas(64)`
+// SIMD state can be read with aligned loads without per-access checks.
 template <class T>
-class polymorphic_value {
+class ISOCPP_P0201_TRIVIALLY_RELOCATABLE polymorphic_value {
   static_assert(!std::is_union<T>::value, "");
   static_assert(std::is_class<T>::value, "");
 
@@ -262,15 +1331,35 @@ class polymorphic_value {
   friend ISOCPP_P0201_CONSTEXPR_CXX20 polymorphic_value<T_>
   allocate_polymorphic_value(std::allocator_arg_t, A& a, Ts&&... ts);
 
+  template <class T_, class ForwardIt, class OutputIt>
+  friend OutputIt clone_n(ForwardIt first, std::size_t n, OutputIt out);
+
+  template <class T_>
+  friend const detail::control_block<T_>* detail::get_control_block(
+      const polymorphic_value<T_>& p) noexcept;
+
+  template <class T_>
+  friend polymorphic_value<T_> detail::adopt_control_block(
+      detail::control_block<T_>* cb);
+
   T* ptr_ = nullptr;
   std::unique_ptr<detail::control_block<T>, detail::control_block_deleter> cb_;
 
  public:
+  // The representation is two pointers, neither of which is pointed back at by
+  // the owned object or control block, so relocation by memcpy is valid.
+  // `folly::IsRelocatable` detects this nested typedef.
+  using IsRelocatable = std::true_type;
+
   //
   // Destructor
   //
 
-  ISOCPP_P0201_CONSTEXPR_CXX20 ~polymorphic_value() = default;
+  ISOCPP_P0201_CONSTEXPR_CXX20 ~polymorphic_value() {
+    if (cb_) {
+      detail::note_destroy<T>();
+    }
+  }
 
   //
   // Constructors
@@ -288,17 +1377,19 @@ class polymorphic_value {
       return;
     }
 
-#ifndef ISOCPP_P0201_POLYMORPHIC_VALUE_NO_RTTI
     if (std::is_same<D, std::default_delete<U>>::value &&
-        std::is_same<C, default_copy<U>>::value && typeid(*u) != typeid(U))
-      throw bad_polymorphic_value_construction();
-#endif
+        std::is_same<C, default_copy<U>>::value &&
+        detail::adopted_type_mismatch(u))
+      ISOCPP_P0201_THROW(bad_polymorphic_value_construction());
+
     std::unique_ptr<U, D> p(u, std::move(deleter));
 
     cb_ = std::unique_ptr<detail::pointer_control_block<T, U, C, D>,
                           detail::control_block_deleter>(
         new detail::pointer_control_block<T, U, C, D>(std::move(p),
                                                       std::move(copier)));
+    detail::note_control_block_allocation<T>(
+        sizeof(detail::pointer_control_block<T, U, C, D>));
     ptr_ = u;
   }
 
@@ -317,6 +1408,27 @@ class polymorphic_value {
           std::is_default_constructible_v<D> && !std::is_pointer_v<D>>>
   explicit constexpr polymorphic_value(U* u) : polymorphic_value(u, C{}, D{}) {}
 
+  template <class U, class D,
+            class = std::enable_if_t<std::is_convertible_v<U*, T*> &&
+                                     std::is_copy_constructible_v<U>>>
+  explicit ISOCPP_P0201_CONSTEXPR_CXX20 polymorphic_value(
+      std::unique_ptr<U, D> p) {
+    if (!p) {
+      return;
+    }
+
+    if (detail::adopted_type_mismatch(p.get()))
+      ISOCPP_P0201_THROW(bad_polymorphic_value_construction());
+
+    U* u = p.get();
+    cb_ = std::unique_ptr<detail::unique_pointer_control_block<T, U, D>,
+                          detail::control_block_deleter>(
+        new detail::unique_pointer_control_block<T, U, D>(std::move(p)));
+    detail::note_control_block_allocation<T>(
+        sizeof(detail::unique_pointer_control_block<T, U, D>));
+    ptr_ = u;
+  }
+
   template <class U, class A,
             class = std::enable_if_t<std::is_convertible_v<U*, T*>>>
   ISOCPP_P0201_CONSTEXPR_CXX20 polymorphic_value(U* u, std::allocator_arg_t,
@@ -325,14 +1437,15 @@ class polymorphic_value {
       return;
     }
 
-#ifndef ISOCPP_P0201_POLYMORPHIC_VALUE_NO_RTTI
-    if (typeid(*u) != typeid(U)) throw bad_polymorphic_value_construction();
-#endif
+    if (detail::adopted_type_mismatch(u))
+      ISOCPP_P0201_THROW(bad_polymorphic_value_construction());
 
     cb_ = std::unique_ptr<detail::allocated_pointer_control_block<T, U, A>,
                           detail::control_block_deleter>(
         detail::allocate_object<
             detail::allocated_pointer_control_block<T, U, A>>(alloc, u, alloc));
+    detail::note_control_block_allocation<T>(
+        sizeof(detail::allocated_pointer_control_block<T, U, A>));
     ptr_ = u;
   }
 
@@ -344,6 +1457,7 @@ class polymorphic_value {
     if (!p) {
       return;
     }
+    detail::note_clone<T>();
     auto tmp_cb = p.cb_->clone();
     ptr_ = tmp_cb->ptr();
     cb_ = std::move(tmp_cb);
@@ -363,16 +1477,81 @@ class polymorphic_value {
   // Converting constructors
   //
 
+  // Copy-converting: clones the source payload straight into this value
+  // instead of copying to a temporary `polymorphic_value<U>` first. Direct
+  // source blocks are cloned into a single allocation that holds the slab
+  // header, the cloned block and the conversion wrapper; other blocks clone
+  // once and wrap the clone.
   template <class U,
             class V = std::enable_if_t<!std::is_same<T, U>::value &&
                                        std::is_convertible<U*, T*>::value>>
   ISOCPP_P0201_CONSTEXPR_CXX20 explicit polymorphic_value(
       const polymorphic_value<U>& p) {
-    polymorphic_value<U> tmp(p);
-    ptr_ = tmp.ptr_;
-    cb_ = std::unique_ptr<detail::delegating_control_block<T, U>,
+    if (!p) {
+      return;
+    }
+    detail::note_clone<T>();
+
+    const std::size_t inner_size = p.cb_->clone_sizeof();
+    if (inner_size != 0) {
+      constexpr std::size_t align = alignof(std::max_align_t);
+      constexpr std::size_t header_size =
+          (sizeof(detail::bulk_arena_header) + align - 1) & ~(align - 1);
+      const std::size_t wrapper_offset =
+          header_size + ((inner_size + align - 1) & ~(align - 1));
+      using wrapper_type = detail::arena_flattened_control_block<T>;
+      const std::size_t total = wrapper_offset + sizeof(wrapper_type);
+
+      void* raw = ::operator new(total);
+      auto* arena = ::new (raw) detail::bulk_arena_header();
+      detail::control_block<U>* inner;
+      ISOCPP_P0201_TRY {
+        inner = p.cb_->clone_into(static_cast<unsigned char*>(raw) +
+                                      header_size,
+                                  arena);
+      }
+      ISOCPP_P0201_CATCH_ALL {
+        detail::bulk_arena_header::release(arena);
+        ISOCPP_P0201_RETHROW;
+      }
+      arena->retain();  // the inner block's reference
+
+      U* u = inner->ptr();
+      T* t = u;
+      void* object = inner->object_address();
+      const std::ptrdiff_t offset =
+          reinterpret_cast<const char*>(t) - static_cast<const char*>(object);
+
+      arena->retain();  // the wrapper's reference
+      auto* wrapper =
+          ::new (static_cast<unsigned char*>(raw) + wrapper_offset)
+              wrapper_type(inner, arena, object, offset);
+      cb_ = std::unique_ptr<wrapper_type, detail::control_block_deleter>(
+          wrapper);
+      ptr_ = t;
+      detail::bulk_arena_header::release(arena);  // the creating reference
+      detail::note_control_block_allocation<T>(total);
+      detail::note_flattened_conversion<T>();
+      return;
+    }
+
+    auto cloned = p.cb_->clone();
+    U* u = cloned->ptr();
+    T* t = u;
+    void* object = cloned->object_address();
+    const std::ptrdiff_t offset =
+        reinterpret_cast<const char*>(t) - static_cast<const char*>(object);
+    std::unique_ptr<detail::erased_control_block,
+                    detail::control_block_deleter>
+        inner(cloned.release());
+    cb_ = std::unique_ptr<detail::flattened_control_block<T>,
                           detail::control_block_deleter>(
-        new detail::delegating_control_block<T, U>(std::move(tmp.cb_)));
+        detail::flattened_control_block<T>::create(std::move(inner), object,
+                                                   offset));
+    detail::note_control_block_allocation<T>(
+        sizeof(detail::flattened_control_block<T>));
+    detail::note_flattened_conversion<T>();
+    ptr_ = t;
   }
 
   template <class U,
@@ -380,10 +1559,34 @@ class polymorphic_value {
                                        std::is_convertible<U*, T*>::value>>
   ISOCPP_P0201_CONSTEXPR_CXX20 explicit polymorphic_value(
       polymorphic_value<U>&& p) {
-    ptr_ = p.ptr_;
-    cb_ = std::unique_ptr<detail::delegating_control_block<T, U>,
+    if (!p) {
+      return;
+    }
+
+    T* t = p.ptr_;
+    void* object = p.cb_->object_address();
+    const std::ptrdiff_t offset =
+        reinterpret_cast<const char*>(t) - static_cast<const char*>(object);
+
+    // If the source block is itself the product of a conversion, take over
+    // its underlying block directly so chains never form.
+    std::unique_ptr<detail::erased_control_block,
+                    detail::control_block_deleter>
+        inner(p.cb_->release_delegate());
+    if (inner) {
+      p.cb_.reset();
+    } else {
+      inner.reset(p.cb_.release());
+    }
+
+    cb_ = std::unique_ptr<detail::flattened_control_block<T>,
                           detail::control_block_deleter>(
-        new detail::delegating_control_block<T, U>(std::move(p.cb_)));
+        detail::flattened_control_block<T>::create(std::move(inner), object,
+                                                   offset));
+    detail::note_control_block_allocation<T>(
+        sizeof(detail::flattened_control_block<T>));
+    detail::note_flattened_conversion<T>();
+    ptr_ = t;
     p.ptr_ = nullptr;
   }
 
@@ -397,11 +1600,14 @@ class polymorphic_value {
                 !is_polymorphic_value<std::decay_t<U>>::value>,
             class... Ts>
   ISOCPP_P0201_CONSTEXPR_CXX20 explicit polymorphic_value(
-      std::in_place_type_t<U>, Ts&&... ts)
-      : cb_(std::unique_ptr<detail::direct_control_block<T, U>,
-                            detail::control_block_deleter>(
-            new detail::direct_control_block<T, U>(std::forward<Ts>(ts)...))) {
-    ptr_ = cb_->ptr();
+      std::in_place_type_t<U>, Ts&&... ts) {
+    auto* cb = new detail::direct_control_block<T, U>(std::forward<Ts>(ts)...);
+    cb_ = std::unique_ptr<detail::direct_control_block<T, U>,
+                          detail::control_block_deleter>(cb);
+    detail::note_control_block_allocation<T>(
+        sizeof(detail::direct_control_block<T, U>));
+    // The block type is final, so this call devirtualizes and inlines.
+    ptr_ = cb->ptr();
   }
 
   //
@@ -419,6 +1625,13 @@ class polymorphic_value {
       return *this;
     }
 
+    // Steady-state path: same concrete payload on both sides, copy-assign
+    // it inside the existing block and skip the alloc/free pair.
+    if (cb_ && cb_->assign_from(*p.cb_)) {
+      return *this;
+    }
+
+    detail::note_clone<T>();
     auto tmp_cb = p.cb_->clone();
     ptr_ = tmp_cb->ptr();
     cb_ = std::move(tmp_cb);
@@ -440,10 +1653,113 @@ class polymorphic_value {
     return *this;
   }
 
+  //
+  // Converting assignment
+  //
+
+  // Rebinds to a value of (possibly derived) type `U` without building an
+  // intermediate `polymorphic_value`: the payload is constructed directly
+  // into reused or fresh control-block storage, as by `emplace`.
+  template <class U,
+            class V = std::enable_if_t<
+                std::is_convertible<std::decay_t<U>*, T*>::value &&
+                !is_polymorphic_value<std::decay_t<U>>::value>>
+  polymorphic_value& operator=(U&& u) {
+    emplace<std::decay_t<U>>(std::forward<U>(u));
+    return *this;
+  }
+
   //
   // Modifiers
   //
 
+  // Replaces the owned object with a `U` constructed from `ts...`. When the
+  // current control block is a direct block whose allocation exactly fits
+  // the replacement, the old object is destroyed and the storage is reused
+  // so rebinding between same-footprint types performs no allocation;
+  // otherwise a fresh block is built first (for the strong guarantee) and
+  // adopted in place of the old one. The arguments may reference the
+  // current object (`*this = **this` arrives here), so the replacement is
+  // always built before the old object is destroyed: staged and moved into
+  // reused storage, or constructed straight into a fresh block.
+  template <class U,
+            class V = std::enable_if_t<
+                std::is_convertible<std::decay_t<U>*, T*>::value &&
+                !is_polymorphic_value<std::decay_t<U>>::value>,
+            class... Ts>
+  T& emplace(Ts&&... ts) {
+    if constexpr (std::is_move_constructible<U>::value) {
+      if (cb_) {
+        U staged(std::forward<Ts>(ts)...);
+        return emplace_block<U>(std::move(staged));
+      }
+    }
+    return emplace_block<U>(std::forward<Ts>(ts)...);
+  }
+
+ private:
+  // Builds the replacement block for `emplace`. The destructive
+  // storage-reuse path is only taken for move-constructible payloads --
+  // which `emplace` stages beforehand, so the arguments here never refer
+  // to an object that path has already destroyed. The fallback paths
+  // construct the replacement while the old object is still alive.
+  template <class U, class... Ts>
+  T& emplace_block(Ts&&... ts) {
+    using block_type = detail::direct_control_block<T, U>;
+    if constexpr (std::is_move_constructible<U>::value) {
+      if (cb_) {
+        void* storage =
+            cb_->try_reuse_storage(sizeof(block_type), alignof(block_type));
+        if (storage) {
+          cb_.release();
+          ptr_ = nullptr;
+          block_type* b;
+          ISOCPP_P0201_TRY {
+            b = ::new (storage) block_type(std::forward<Ts>(ts)...);
+          }
+          ISOCPP_P0201_CATCH_ALL {
+            detail::control_block<T>::deallocate_storage(
+                storage, sizeof(block_type), alignof(block_type));
+            ISOCPP_P0201_RETHROW;
+          }
+          cb_ = std::unique_ptr<block_type, detail::control_block_deleter>(b);
+          ptr_ = b->ptr();
+          return *ptr_;
+        }
+      }
+    }
+    // Fresh storage: build the replacement block first for the strong
+    // guarantee, then adopt it directly -- no intermediate
+    // `polymorphic_value` object. Allocator-backed blocks hand out
+    // same-family storage so the replacement keeps their allocator.
+    if (cb_) {
+      using replaced_type = detail::replaced_direct_control_block<T, U>;
+      void* storage = nullptr;
+      detail::replacement_family* family =
+          cb_->allocate_replacement(sizeof(replaced_type), storage);
+      if (family) {
+        replaced_type* b;
+        ISOCPP_P0201_TRY {
+          b = ::new (storage) replaced_type(family, std::forward<Ts>(ts)...);
+        }
+        ISOCPP_P0201_CATCH_ALL {
+          family->dispose(storage, sizeof(replaced_type));
+          ISOCPP_P0201_RETHROW;
+        }
+        detail::note_control_block_allocation<T>(sizeof(replaced_type));
+        cb_ = std::unique_ptr<replaced_type, detail::control_block_deleter>(b);
+        ptr_ = b->ptr();
+        return *ptr_;
+      }
+    }
+    auto* b = new block_type(std::forward<Ts>(ts)...);
+    detail::note_control_block_allocation<T>(sizeof(block_type));
+    cb_ = std::unique_ptr<block_type, detail::control_block_deleter>(b);
+    ptr_ = b->ptr();
+    return *ptr_;
+  }
+
+ public:
   constexpr void swap(polymorphic_value& p) noexcept {
     using std::swap;
     swap(ptr_, p.ptr_);
@@ -456,23 +1772,52 @@ class polymorphic_value {
 
   constexpr explicit operator bool() const { return bool(cb_); }
 
+  // Checked observers assert on `ptr_` alone: it is null exactly when the
+  // value is empty, and checking it avoids touching `cb_` -- a dead load of
+  // the second member on every dereference.
+
   constexpr const T* operator->() const {
     assert(ptr_);
     return ptr_;
   }
 
   constexpr const T& operator*() const {
-    assert(*this);
+    assert(ptr_);
     return *ptr_;
   }
 
   constexpr T* operator->() {
-    assert(*this);
+    assert(ptr_);
     return ptr_;
   }
 
   constexpr T& operator*() {
-    assert(*this);
+    assert(ptr_);
+    return *ptr_;
+  }
+
+  // Unchecked observers: one load of `ptr_`, no assert even in builds that
+  // keep asserts enabled, and a compiler assumption of non-emptiness so the
+  // null case vanishes from surrounding codegen. Calling these on an empty
+  // `polymorphic_value` is undefined behaviour.
+
+  const T* unchecked_ptr() const noexcept {
+    ISOCPP_P0201_ASSUME(ptr_ != nullptr);
+    return ptr_;
+  }
+
+  const T& unchecked() const noexcept {
+    ISOCPP_P0201_ASSUME(ptr_ != nullptr);
+    return *ptr_;
+  }
+
+  T* unchecked_ptr() noexcept {
+    ISOCPP_P0201_ASSUME(ptr_ != nullptr);
+    return ptr_;
+  }
+
+  T& unchecked() noexcept {
+    ISOCPP_P0201_ASSUME(ptr_ != nullptr);
     return *ptr_;
   }
 };
@@ -484,10 +1829,13 @@ template <class T, class U = T, class... Ts>
 ISOCPP_P0201_CONSTEXPR_CXX20 polymorphic_value<T> make_polymorphic_value(
     Ts&&... ts) {
   polymorphic_value<T> p;
+  auto* cb = new detail::direct_control_block<T, U>(std::forward<Ts>(ts)...);
   p.cb_ = std::unique_ptr<detail::direct_control_block<T, U>,
-                          detail::control_block_deleter>(
-      new detail::direct_control_block<T, U>(std::forward<Ts>(ts)...));
-  p.ptr_ = p.cb_->ptr();
+                          detail::control_block_deleter>(cb);
+  detail::note_control_block_allocation<T>(
+      sizeof(detail::direct_control_block<T, U>));
+  // The block type is final, so this call devirtualizes and inlines.
+  p.ptr_ = cb->ptr();
   return p;
 }
 
@@ -495,20 +1843,240 @@ template <class T, class U = T, class A = std::allocator<U>, class... Ts>
 ISOCPP_P0201_CONSTEXPR_CXX20 polymorphic_value<T> allocate_polymorphic_value(
     std::allocator_arg_t, A& a, Ts&&... ts) {
   polymorphic_value<T> p;
-  auto* u = detail::allocate_object<U>(a, std::forward<Ts>(ts)...);
+  auto* cb =
+      detail::allocate_object<detail::allocated_direct_control_block<T, U, A>>(
+          a, a, std::forward<Ts>(ts)...);
+  p.cb_ = std::unique_ptr<detail::allocated_direct_control_block<T, U, A>,
+                          detail::control_block_deleter>(cb);
+  detail::note_control_block_allocation<T>(
+      sizeof(detail::allocated_direct_control_block<T, U, A>));
+  p.ptr_ = cb->ptr();
+  return p;
+}
+
+//
+// Exception-free creation
+//
+// The `try_*` factories mirror `make_polymorphic_value` and the pointer
+// constructors but report failure by returning an empty value instead of
+// throwing, so the dynamic/static type check is an ordinary branch. They are
+// the intended creation API when this header is compiled without exception
+// support.
+//
+
+template <class T, class U = T, class... Ts>
+polymorphic_value<T> try_make_polymorphic_value(Ts&&... ts) noexcept {
+#if ISOCPP_P0201_HAS_EXCEPTIONS
   try {
-    p.cb_ = std::unique_ptr<detail::allocated_pointer_control_block<T, U, A>,
-                            detail::control_block_deleter>(
-        detail::allocate_object<
-            detail::allocated_pointer_control_block<T, U, A>>(a, u, a));
+    return make_polymorphic_value<T, U>(std::forward<Ts>(ts)...);
   } catch (...) {
-    detail::deallocate_object(a, u);
-    throw;
+    return polymorphic_value<T>();
+  }
+#else
+  // Without exceptions `U`'s constructor cannot throw, so the only
+  // recoverable failure is allocation; request the storage with a nothrow
+  // form and report exhaustion as an empty value.
+  using block_type = detail::direct_control_block<T, U>;
+  void* raw;
+#ifdef __cpp_aligned_new
+  if (detail::is_over_aligned(alignof(block_type))) {
+    raw = ::operator new(sizeof(block_type),
+                         std::align_val_t(alignof(block_type)), std::nothrow);
+  } else
+#endif
+  {
+#ifdef ISOCPP_P0201_POLYMORPHIC_VALUE_USE_CONTROL_BLOCK_POOL
+    raw = detail::control_block<T>::allocate_storage(sizeof(block_type),
+                                                     alignof(block_type));
+#else
+    raw = ::operator new(sizeof(block_type), std::nothrow);
+#endif
+  }
+  if (!raw) {
+    return polymorphic_value<T>();
+  }
+  auto* cb = ::new (raw) block_type(std::forward<Ts>(ts)...);
+  detail::note_control_block_allocation<T>(sizeof(block_type));
+  return detail::adopt_control_block<T>(cb);
+#endif  // ISOCPP_P0201_HAS_EXCEPTIONS
+}
+
+// Adopts `u` exactly as the matching pointer constructor would. On a
+// dynamic/static type mismatch the result is empty and ownership of `u`
+// stays with the caller, as it would after the throwing constructor; if
+// building the control block fails, `u` is destroyed with `deleter`.
+template <class T, class U, class C = default_copy<U>,
+          class D = typename copier_traits<C>::deleter_type,
+          class = std::enable_if_t<std::is_convertible_v<U*, T*>>>
+polymorphic_value<T> try_adopt(U* u, C copier = C{}, D deleter = D{}) noexcept {
+  if (!u) {
+    return polymorphic_value<T>();
+  }
+
+  if (std::is_same<D, std::default_delete<U>>::value &&
+      std::is_same<C, default_copy<U>>::value &&
+      detail::adopted_type_mismatch(u)) {
+    return polymorphic_value<T>();
+  }
+
+  ISOCPP_P0201_TRY {
+    return polymorphic_value<T>(u, std::move(copier), std::move(deleter));
   }
-  p.ptr_ = p.cb_->ptr();
+  ISOCPP_P0201_CATCH_ALL {}
+  return polymorphic_value<T>();
+}
+
+namespace detail {
+
+template <class T>
+polymorphic_value<T> adopt_control_block(control_block<T>* cb) {
+  polymorphic_value<T> p;
+  p.cb_ = std::unique_ptr<control_block<T>, control_block_deleter>(cb);
+  p.ptr_ = cb ? p.cb_->ptr() : nullptr;
   return p;
 }
 
+template <class T>
+const control_block<T>* get_control_block(
+    const polymorphic_value<T>& p) noexcept {
+  return p.cb_.get();
+}
+
+// Candidate dispatch for `visit`: one pointer compare per listed type, in
+// list order, falling back to the base reference when nothing matches.
+template <class T, class Visitor>
+decltype(auto) visit_candidates(const void*, const T& t, Visitor&& visitor) {
+  return std::forward<Visitor>(visitor)(t);
+}
+
+template <class U0, class... Us, class T, class Visitor>
+decltype(auto) visit_candidates(const void* key, const T& t,
+                                Visitor&& visitor) {
+  if (key == payload_type_key<U0>()) {
+    return std::forward<Visitor>(visitor)(static_cast<const U0&>(t));
+  }
+  return visit_candidates<Us...>(key, t, std::forward<Visitor>(visitor));
+}
+
+template <class T, class Visitor>
+decltype(auto) visit_candidates(const void*, T& t, Visitor&& visitor) {
+  return std::forward<Visitor>(visitor)(t);
+}
+
+template <class U0, class... Us, class T, class Visitor>
+decltype(auto) visit_candidates(const void* key, T& t, Visitor&& visitor) {
+  if (key == payload_type_key<U0>()) {
+    return std::forward<Visitor>(visitor)(static_cast<U0&>(t));
+  }
+  return visit_candidates<Us...>(key, t, std::forward<Visitor>(visitor));
+}
+
+}  // end namespace detail
+
+//
+// Closed-set visitation
+//
+// `visit<Us...>(p, visitor)` resolves the dynamic type of the stored object
+// against the candidate list using the control block's stored payload
+// identity — no RTTI, no dynamic_cast — and invokes the visitor with a
+// reference to the concrete type. Candidates are tested in declaration
+// order with one pointer compare each, so listing the hot type first turns
+// a type-homogeneous stream into a single predicted branch per element.
+// Objects whose type is not listed, or that were adopted through a pointer
+// (whose pointee may be more derived than its static type), invoke the
+// visitor with the base `T` reference instead.
+template <class... Us, class T, class Visitor>
+decltype(auto) visit(const polymorphic_value<T>& p, Visitor&& visitor) {
+  assert(bool(p));
+  const void* key = detail::get_control_block(p)->payload_key();
+  return detail::visit_candidates<Us...>(key, *p,
+                                         std::forward<Visitor>(visitor));
+}
+
+template <class... Us, class T, class Visitor>
+decltype(auto) visit(polymorphic_value<T>& p, Visitor&& visitor) {
+  assert(bool(p));
+  const void* key = detail::get_control_block(p)->payload_key();
+  return detail::visit_candidates<Us...>(key, *p,
+                                         std::forward<Visitor>(visitor));
+}
+
+//
+// Bulk clone
+//
+// Clones the `polymorphic_value<T>` range [first, first + n) into `out`.
+// Sources whose control blocks support arena cloning (the in-place /
+// make_polymorphic_value path) are placement-constructed back-to-back in a
+// single slab sized up front, so an N-element copy costs one allocation plus
+// a linear pass; other sources fall back to their regular `clone()`. The slab
+// is freed when the last clone made from it is destroyed.
+template <class T, class ForwardIt, class OutputIt>
+OutputIt clone_n(ForwardIt first, std::size_t n, OutputIt out) {
+  constexpr std::size_t align = alignof(std::max_align_t);
+  const auto align_up = [](std::size_t offset) {
+    return (offset + align - 1) & ~(align - 1);
+  };
+
+  std::size_t total = 0;
+  {
+    ForwardIt it = first;
+    for (std::size_t i = 0; i != n; ++i, ++it) {
+      const polymorphic_value<T>& src = *it;
+      if (src) {
+        const std::size_t size = src.cb_->clone_sizeof();
+        if (size != 0) {
+          total = align_up(total) + size;
+        }
+      }
+    }
+  }
+
+  detail::bulk_arena_header* arena = nullptr;
+  unsigned char* data = nullptr;
+  if (total != 0) {
+    constexpr std::size_t header_size =
+        (sizeof(detail::bulk_arena_header) + align - 1) & ~(align - 1);
+    void* raw = ::operator new(header_size + total);
+    arena = ::new (raw) detail::bulk_arena_header();
+    data = static_cast<unsigned char*>(raw) + header_size;
+  }
+
+  std::size_t offset = 0;
+  ISOCPP_P0201_TRY {
+    for (std::size_t i = 0; i != n; ++i, ++first) {
+      const polymorphic_value<T>& src = *first;
+      if (!src) {
+        *out++ = polymorphic_value<T>();
+        continue;
+      }
+      const std::size_t size = src.cb_->clone_sizeof();
+      if (size == 0) {
+        *out++ = src;
+        continue;
+      }
+      offset = align_up(offset);
+      detail::control_block<T>* cb = src.cb_->clone_into(data + offset, arena);
+      offset += size;
+      arena->retain();
+      polymorphic_value<T> p;
+      p.cb_ = std::unique_ptr<detail::control_block<T>,
+                              detail::control_block_deleter>(cb);
+      p.ptr_ = cb->ptr();
+      *out++ = std::move(p);
+    }
+  }
+  ISOCPP_P0201_CATCH_ALL {
+    if (arena) {
+      detail::bulk_arena_header::release(arena);
+    }
+    ISOCPP_P0201_RETHROW;
+  }
+  if (arena) {
+    detail::bulk_arena_header::release(arena);
+  }
+  return out;
+}
+
 //
 // non-member swap
 //
@@ -517,6 +2085,35 @@ constexpr void swap(polymorphic_value<T>& t, polymorphic_value<T>& u) noexcept {
   t.swap(u);
 }
 
+#ifdef ISOCPP_P0201_POLYMORPHIC_VALUE_HAS_MEMORY_RESOURCE
+
+//
+// std::pmr support
+//
+// `pmr::polymorphic_value<T>` objects created with `pmr::make_polymorphic_value`
+// store a `std::pmr::polymorphic_allocator` (and with it the chosen
+// `memory_resource`) in the control block, so every allocation, clone and
+// destroy is routed through the resource, which survives copies. The resource
+// is selected at runtime; no per-allocator control-block stack is
+// instantiated.
+namespace pmr {
+
+template <class T>
+using polymorphic_value = ::isocpp_p0201::polymorphic_value<T>;
+
+template <class T, class U = T, class... Ts>
+ISOCPP_P0201_CONSTEXPR_CXX20 polymorphic_value<T> make_polymorphic_value(
+    std::pmr::memory_resource* resource, Ts&&... ts) {
+  assert(resource);
+  std::pmr::polymorphic_allocator<U> alloc(resource);
+  return allocate_polymorphic_value<T, U>(std::allocator_arg, alloc,
+                                          std::forward<Ts>(ts)...);
+}
+
+}  // namespace pmr
+
+#endif  // ISOCPP_P0201_POLYMORPHIC_VALUE_HAS_MEMORY_RESOURCE
+
 }  // namespace isocpp_p0201
 
 #endif  // ISOCPP_P0201_POLYMORPHIC_VALUE_H_INCLUDED
@@ -0,0 +1,207 @@
+/* Copyright (c) 2016 The Polymorphic Value Authors. All Rights Reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+==============================================================================*/
+
+#include <memory>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "polymorphic_value.h"
+
+using namespace isocpp_p0201;
+
+namespace {
+
+struct Shape {
+  virtual ~Shape() = default;
+  virtual double area() const = 0;
+};
+
+struct SmallShape : Shape {
+  double side_ = 2.0;
+
+  SmallShape() = default;
+  explicit SmallShape(double side) : side_(side) {}
+
+  double area() const override { return side_ * side_; }
+};
+
+struct LargeShape : Shape {
+  double sides_[64] = {};
+
+  LargeShape() { sides_[0] = 2.0; }
+
+  double area() const override { return sides_[0] * sides_[0]; }
+};
+
+}  // namespace
+
+//
+// Construction: make_polymorphic_value vs a plain heap allocation.
+//
+
+static void BM_MakePolymorphicValue(benchmark::State& state) {
+  for (auto _ : state) {
+    auto p = make_polymorphic_value<Shape, SmallShape>(2.0);
+    benchmark::DoNotOptimize(p.operator->());
+  }
+}
+BENCHMARK(BM_MakePolymorphicValue);
+
+static void BM_MakeUniquePtr(benchmark::State& state) {
+  for (auto _ : state) {
+    std::unique_ptr<Shape> p = std::make_unique<SmallShape>(2.0);
+    benchmark::DoNotOptimize(p.get());
+  }
+}
+BENCHMARK(BM_MakeUniquePtr);
+
+//
+// Copy: small vs large stored objects.
+//
+
+static void BM_CopySmall(benchmark::State& state) {
+  auto p = make_polymorphic_value<Shape, SmallShape>(2.0);
+  for (auto _ : state) {
+    polymorphic_value<Shape> q(p);
+    benchmark::DoNotOptimize(q.operator->());
+  }
+}
+BENCHMARK(BM_CopySmall);
+
+static void BM_CopyLarge(benchmark::State& state) {
+  auto p = make_polymorphic_value<Shape, LargeShape>();
+  for (auto _ : state) {
+    polymorphic_value<Shape> q(p);
+    benchmark::DoNotOptimize(q.operator->());
+  }
+}
+BENCHMARK(BM_CopyLarge);
+
+//
+// Copy: direct_control_block vs pointer_control_block clone paths.
+//
+
+static void BM_CopyDirectControlBlock(benchmark::State& state) {
+  polymorphic_value<Shape> p(std::in_place_type<SmallShape>, 2.0);
+  for (auto _ : state) {
+    polymorphic_value<Shape> q(p);
+    benchmark::DoNotOptimize(q.operator->());
+  }
+}
+BENCHMARK(BM_CopyDirectControlBlock);
+
+static void BM_CopyPointerControlBlock(benchmark::State& state) {
+  polymorphic_value<Shape> p(new SmallShape(2.0));
+  for (auto _ : state) {
+    polymorphic_value<Shape> q(p);
+    benchmark::DoNotOptimize(q.operator->());
+  }
+}
+BENCHMARK(BM_CopyPointerControlBlock);
+
+//
+// Move.
+//
+
+static void BM_Move(benchmark::State& state) {
+  auto p = make_polymorphic_value<Shape, SmallShape>(2.0);
+  for (auto _ : state) {
+    polymorphic_value<Shape> q(std::move(p));
+    benchmark::DoNotOptimize(q.operator->());
+    p = std::move(q);
+  }
+}
+BENCHMARK(BM_Move);
+
+//
+// Conversion flattening: each converting construction rebuilds a single
+// flattened_control_block over the original direct block, so clone() and
+// ptr() cost the same however many base conversions the value has been
+// through. Copying at depths 1-3 should report identical times.
+//
+
+struct Level0 {
+  virtual ~Level0() = default;
+  int v_ = 0;
+};
+struct Level1 : Level0 {};
+struct Level2 : Level1 {};
+struct Level3 : Level2 {};
+
+// Builds a polymorphic_value<Level0> that has been through `depth` base
+// conversions.
+static polymorphic_value<Level0> make_chain(int depth) {
+  polymorphic_value<Level3> p3(std::in_place_type<Level3>);
+  if (depth <= 1) {
+    return polymorphic_value<Level0>(std::move(p3));
+  }
+  polymorphic_value<Level2> p2(std::move(p3));
+  if (depth == 2) {
+    return polymorphic_value<Level0>(std::move(p2));
+  }
+  polymorphic_value<Level1> p1(std::move(p2));
+  return polymorphic_value<Level0>(std::move(p1));
+}
+
+static void BM_CopyConvertedValue(benchmark::State& state) {
+  polymorphic_value<Level0> p = make_chain(static_cast<int>(state.range(0)));
+
+  for (auto _ : state) {
+    polymorphic_value<Level0> q(p);
+    benchmark::DoNotOptimize(q.operator->());
+  }
+}
+BENCHMARK(BM_CopyConvertedValue)->Arg(1)->Arg(2)->Arg(3);
+
+//
+// Iteration: vector<polymorphic_value<T>> vs vector<unique_ptr<T>>.
+//
+
+static void BM_IteratePolymorphicValueVector(benchmark::State& state) {
+  std::vector<polymorphic_value<Shape>> v;
+  for (int i = 0; i < state.range(0); ++i) {
+    v.push_back(make_polymorphic_value<Shape, SmallShape>(double(i)));
+  }
+
+  for (auto _ : state) {
+    double total = 0.0;
+    for (const auto& p : v) {
+      total += p->area();
+    }
+    benchmark::DoNotOptimize(total);
+  }
+}
+BENCHMARK(BM_IteratePolymorphicValueVector)->Arg(1024);
+
+static void BM_IterateUniquePtrVector(benchmark::State& state) {
+  std::vector<std::unique_ptr<Shape>> v;
+  for (int i = 0; i < state.range(0); ++i) {
+    v.push_back(std::make_unique<SmallShape>(double(i)));
+  }
+
+  for (auto _ : state) {
+    double total = 0.0;
+    for (const auto& p : v) {
+      total += p->area();
+    }
+    benchmark::DoNotOptimize(total);
+  }
+}
+BENCHMARK(BM_IterateUniquePtrVector)->Arg(1024);
@@ -0,0 +1,272 @@
+/* Copyright (c) 2016 The Polymorphic Value Authors. All Rights Reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+==============================================================================*/
+
+#ifndef ISOCPP_P0201_POLYMORPHIC_VALUE_FOR_H_INCLUDED
+#define ISOCPP_P0201_POLYMORPHIC_VALUE_FOR_H_INCLUDED
+
+#include <cassert>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace isocpp_p0201 {
+
+namespace detail {
+
+////////////////////////////////////////////////////////////////////////////
+// Implementation detail classes
+////////////////////////////////////////////////////////////////////////////
+
+template <bool... Bs>
+struct bool_pack {};
+
+template <bool... Bs>
+using all_of = std::is_same<bool_pack<true, Bs...>, bool_pack<Bs..., true>>;
+
+template <class U, class... Us>
+struct pack_contains : std::false_type {};
+
+template <class U, class V, class... Us>
+struct pack_contains<U, V, Us...> : pack_contains<U, Us...> {};
+
+template <class U, class... Us>
+struct pack_contains<U, U, Us...> : std::true_type {};
+
+// Per-alternative operations for the closed set: copy/move into caller
+// storage plus the U*-to-T* adjustment, dispatched by alternative index.
+template <class T>
+struct closed_set_vtable {
+  void (*copy_to)(const void* src, void* dst);
+  void (*move_to)(void* src, void* dst);
+  void (*destroy)(void* p) noexcept;
+  T* (*ptr)(void* p) noexcept;
+};
+
+template <class T, class U>
+struct closed_set_ops {
+  static void copy_to(const void* src, void* dst) {
+    ::new (dst) U(*static_cast<const U*>(src));
+  }
+
+  static void move_to(void* src, void* dst) {
+    ::new (dst) U(std::move(*static_cast<U*>(src)));
+  }
+
+  static void destroy(void* p) noexcept { static_cast<U*>(p)->~U(); }
+
+  static T* ptr(void* p) noexcept { return static_cast<U*>(p); }
+
+  static constexpr closed_set_vtable<T> vtable = {&copy_to, &move_to, &destroy,
+                                                  &ptr};
+};
+
+template <class T, class U>
+constexpr closed_set_vtable<T> closed_set_ops<T, U>::vtable;
+
+}  // end namespace detail
+
+////////////////////////////////////////////////////////////////////////////////
+// `polymorphic_value_for` class definition
+////////////////////////////////////////////////////////////////////////////////
+
+// A closed-set counterpart to `polymorphic_value`: the set of derived types is
+// fixed at compile time, so the active object lives in inline union storage
+// sized and aligned for the pack and copy/destroy dispatch on an alternative
+// index rather than a heap-allocated control block. Construction, copying and
+// destruction are allocation-free.
+template <class T, class... Us>
+class polymorphic_value_for {
+  static_assert(!std::is_union<T>::value, "");
+  static_assert(std::is_class<T>::value, "");
+  static_assert(sizeof...(Us) > 0, "the set of stored types must be non-empty");
+  static_assert(
+      detail::all_of<std::is_convertible<Us*, T*>::value...>::value,
+      "each stored type must be publicly derived from the erased type");
+
+  static constexpr std::size_t npos = sizeof...(Us);
+
+  std::aligned_union_t<1, Us...> storage_;
+  T* ptr_ = nullptr;
+  std::size_t index_ = npos;
+
+  static const detail::closed_set_vtable<T>* ops_for(std::size_t i) {
+    static constexpr const detail::closed_set_vtable<T>* tables[] = {
+        &detail::closed_set_ops<T, Us>::vtable...};
+    assert(i < npos);
+    return tables[i];
+  }
+
+  template <class U>
+  static constexpr std::size_t index_of() {
+    constexpr bool matches[] = {std::is_same<U, Us>::value...};
+    std::size_t i = 0;
+    while (i != npos && !matches[i]) ++i;
+    return i;
+  }
+
+  void reset() noexcept {
+    if (index_ != npos) {
+      ops_for(index_)->destroy(&storage_);
+      ptr_ = nullptr;
+      index_ = npos;
+    }
+  }
+
+ public:
+  //
+  // Destructor
+  //
+
+  ~polymorphic_value_for() { reset(); }
+
+  //
+  // Constructors
+  //
+
+  polymorphic_value_for() = default;
+
+  template <class U, class V = std::decay_t<U>,
+            class = std::enable_if_t<detail::pack_contains<V, Us...>::value>>
+  polymorphic_value_for(U&& u) {
+    emplace<V>(std::forward<U>(u));
+  }
+
+  //
+  // Copy-constructors
+  //
+
+  polymorphic_value_for(const polymorphic_value_for& p) {
+    if (p.index_ == npos) {
+      return;
+    }
+    const auto* ops = ops_for(p.index_);
+    ops->copy_to(&p.storage_, &storage_);
+    ptr_ = ops->ptr(&storage_);
+    index_ = p.index_;
+  }
+
+  //
+  // Move-constructors
+  //
+
+  polymorphic_value_for(polymorphic_value_for&& p) {
+    if (p.index_ == npos) {
+      return;
+    }
+    const auto* ops = ops_for(p.index_);
+    ops->move_to(&p.storage_, &storage_);
+    ptr_ = ops->ptr(&storage_);
+    index_ = p.index_;
+    p.reset();
+  }
+
+  //
+  // Assignment
+  //
+
+  polymorphic_value_for& operator=(const polymorphic_value_for& p) {
+    if (std::addressof(p) == this) {
+      return *this;
+    }
+    polymorphic_value_for tmp(p);
+    *this = std::move(tmp);
+    return *this;
+  }
+
+  polymorphic_value_for& operator=(polymorphic_value_for&& p) {
+    if (std::addressof(p) == this) {
+      return *this;
+    }
+    reset();
+    if (p.index_ != npos) {
+      const auto* ops = ops_for(p.index_);
+      ops->move_to(&p.storage_, &storage_);
+      ptr_ = ops->ptr(&storage_);
+      index_ = p.index_;
+      p.reset();
+    }
+    return *this;
+  }
+
+  //
+  // Modifiers
+  //
+
+  template <class U, class... Ts>
+  U& emplace(Ts&&... ts) {
+    static_assert(detail::pack_contains<U, Us...>::value,
+                  "emplaced type must be one of the stored types");
+    reset();
+    U* u = ::new (&storage_) U(std::forward<Ts>(ts)...);
+    ptr_ = u;
+    index_ = index_of<U>();
+    return *u;
+  }
+
+  void swap(polymorphic_value_for& p) {
+    polymorphic_value_for tmp(std::move(*this));
+    *this = std::move(p);
+    p = std::move(tmp);
+  }
+
+  //
+  // Observers
+  //
+
+  explicit operator bool() const { return index_ != npos; }
+
+  // Index of the active alternative within `Us...`, or `sizeof...(Us)` when
+  // empty.
+  std::size_t index() const { return index_; }
+
+  const T* operator->() const {
+    assert(ptr_);
+    return ptr_;
+  }
+
+  const T& operator*() const {
+    assert(ptr_);
+    return *ptr_;
+  }
+
+  T* operator->() {
+    assert(ptr_);
+    return ptr_;
+  }
+
+  T& operator*() {
+    assert(ptr_);
+    return *ptr_;
+  }
+};
+
+//
+// non-member swap
+//
+template <class T, class... Us>
+void swap(polymorphic_value_for<T, Us...>& t,
+          polymorphic_value_for<T, Us...>& u) {
+  t.swap(u);
+}
+
+}  // namespace isocpp_p0201
+
+#endif  // ISOCPP_P0201_POLYMORPHIC_VALUE_FOR_H_INCLUDED
@@ -0,0 +1,192 @@
+/* Copyright (c) 2016 The Polymorphic Value Authors. All Rights Reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+==============================================================================*/
+
+#include "polymorphic_value_for.h"
+
+#include <utility>
+
+#undef CATCH_CONFIG_WINDOWS_SEH
+#include "catch2/catch_test_macros.hpp"
+
+using namespace isocpp_p0201;
+
+namespace {
+struct Order {
+  virtual int value() const = 0;
+  virtual void set_value(int) = 0;
+  virtual ~Order() = default;
+};
+
+// Class-level operator new so a test can verify the closed-set value never
+// heap-allocates its stored object (inline placement-new does not call it).
+template <class Derived>
+struct CountedOrder : Order {
+  int value_ = 0;
+
+  CountedOrder(int v) : value_(v) { ++object_count; }
+
+  CountedOrder(const CountedOrder& o) : value_(o.value_) { ++object_count; }
+
+  CountedOrder(CountedOrder&& o) : value_(o.value_) { ++object_count; }
+
+  ~CountedOrder() { --object_count; }
+
+  int value() const override { return value_; }
+
+  void set_value(int i) override { value_ = i; }
+
+  static void* operator new(std::size_t size) {
+    ++allocation_count;
+    return ::operator new(size);
+  }
+
+  static void operator delete(void* p) { ::operator delete(p); }
+
+  static size_t object_count;
+  static size_t allocation_count;
+};
+
+template <class Derived>
+size_t CountedOrder<Derived>::object_count = 0;
+
+template <class Derived>
+size_t CountedOrder<Derived>::allocation_count = 0;
+
+struct LimitOrder : CountedOrder<LimitOrder> {
+  using CountedOrder::CountedOrder;
+};
+
+struct MarketOrder : CountedOrder<MarketOrder> {
+  double padding_[4] = {};
+
+  using CountedOrder::CountedOrder;
+};
+
+using order_value = polymorphic_value_for<Order, LimitOrder, MarketOrder>;
+
+}  // namespace
+
+TEST_CASE("polymorphic_value_for default constructor",
+          "[polymorphic_value_for.constructors]") {
+  order_value o;
+
+  CHECK(!bool(o));
+  CHECK(o.index() == 2);
+}
+
+TEST_CASE("polymorphic_value_for value constructor",
+          "[polymorphic_value_for.constructors]") {
+  order_value o(LimitOrder(7));
+
+  REQUIRE(bool(o));
+  CHECK(o.index() == 0);
+  CHECK(o->value() == 7);
+  CHECK((*o).value() == 7);
+
+  order_value m(MarketOrder(8));
+  CHECK(m.index() == 1);
+  CHECK(m->value() == 8);
+}
+
+TEST_CASE("polymorphic_value_for performs no heap allocation",
+          "[polymorphic_value_for.storage]") {
+  LimitOrder::allocation_count = 0;
+  MarketOrder::allocation_count = 0;
+
+  order_value o(LimitOrder(1));
+  order_value p(o);
+  order_value q(std::move(p));
+  q.emplace<MarketOrder>(2);
+
+  CHECK(LimitOrder::allocation_count == 0);
+  CHECK(MarketOrder::allocation_count == 0);
+}
+
+TEST_CASE("polymorphic_value_for copy is deep",
+          "[polymorphic_value_for.copy]") {
+  REQUIRE(LimitOrder::object_count == 0);
+  {
+    order_value o(LimitOrder(5));
+    order_value p(o);
+
+    REQUIRE(bool(p));
+    CHECK(LimitOrder::object_count == 2);
+    CHECK(p->value() == 5);
+    CHECK(p.operator->() != o.operator->());
+
+    p->set_value(6);
+    CHECK(o->value() == 5);
+  }
+  CHECK(LimitOrder::object_count == 0);
+}
+
+TEST_CASE("polymorphic_value_for move leaves source empty",
+          "[polymorphic_value_for.move]") {
+  order_value o(MarketOrder(9));
+  order_value p(std::move(o));
+
+  CHECK(!bool(o));
+  REQUIRE(bool(p));
+  CHECK(p->value() == 9);
+  CHECK(MarketOrder::object_count == 1);
+}
+
+TEST_CASE("polymorphic_value_for assignment",
+          "[polymorphic_value_for.assignment]") {
+  order_value o(LimitOrder(1));
+  order_value p(MarketOrder(2));
+
+  o = p;
+  CHECK(o.index() == 1);
+  CHECK(o->value() == 2);
+  CHECK(LimitOrder::object_count == 0);
+
+  order_value q;
+  q = std::move(o);
+  CHECK(!bool(o));
+  CHECK(q->value() == 2);
+
+  q = order_value();
+  CHECK(!bool(q));
+  CHECK(MarketOrder::object_count == 1);  // p still holds its object.
+}
+
+TEST_CASE("polymorphic_value_for emplace replaces the stored object",
+          "[polymorphic_value_for.modifiers]") {
+  order_value o(LimitOrder(1));
+
+  MarketOrder& m = o.emplace<MarketOrder>(3);
+  CHECK(o.index() == 1);
+  CHECK(o->value() == 3);
+  CHECK(&m == o.operator->());
+  CHECK(LimitOrder::object_count == 0);
+}
+
+TEST_CASE("polymorphic_value_for swap", "[polymorphic_value_for.swap]") {
+  order_value o(LimitOrder(1));
+  order_value p(MarketOrder(2));
+
+  swap(o, p);
+
+  CHECK(o->value() == 2);
+  CHECK(o.index() == 1);
+  CHECK(p->value() == 1);
+  CHECK(p.index() == 0);
+}
@@ -0,0 +1,135 @@
+/* Copyright (c) 2016 The Polymorphic Value Authors. All Rights Reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+==============================================================================*/
+
+#define ISOCPP_P0201_POLYMORPHIC_VALUE_INSTRUMENTATION
+#include "polymorphic_value.h"
+
+#include <utility>
+
+#undef CATCH_CONFIG_WINDOWS_SEH
+#include "catch2/catch_test_macros.hpp"
+
+using namespace isocpp_p0201;
+
+namespace {
+// This translation unit is compiled with instrumentation enabled while the
+// others are not, so the erased types used here are local to this file: the
+// instrumented template specializations must not collide with uninstrumented
+// ones elsewhere in the test binary.
+struct InstrBase {
+  virtual int value() const = 0;
+  virtual ~InstrBase() = default;
+};
+
+struct InstrDerived : InstrBase {
+  int value_ = 0;
+
+  InstrDerived(int v) : value_(v) {}
+
+  int value() const override { return value_; }
+};
+
+struct InstrMoreDerived : InstrDerived {
+  using InstrDerived::InstrDerived;
+};
+
+size_t hook_allocates = 0;
+size_t hook_clones = 0;
+size_t hook_destroys = 0;
+
+void counting_hook(instrumentation_event event, std::size_t bytes) {
+  switch (event) {
+    case instrumentation_event::allocate:
+      REQUIRE(bytes > 0);
+      ++hook_allocates;
+      break;
+    case instrumentation_event::clone:
+      ++hook_clones;
+      break;
+    case instrumentation_event::destroy:
+      ++hook_destroys;
+      break;
+  }
+}
+
+}  // namespace
+
+TEST_CASE("Instrumentation counts allocations and clones",
+          "[polymorphic_value.instrumentation]") {
+  reset_instrumentation<InstrBase>();
+
+  {
+    polymorphic_value<InstrBase> p =
+        make_polymorphic_value<InstrBase, InstrDerived>(1);
+    polymorphic_value<InstrBase> p2(p);
+    polymorphic_value<InstrBase> p3;
+    p3 = p2;
+  }
+
+  instrumentation_stats stats = instrumentation_snapshot<InstrBase>();
+  CHECK(stats.control_block_allocations == 1);
+  CHECK(stats.clone_calls == 2);
+  CHECK(stats.bytes_allocated > 0);
+  CHECK(stats.flattened_conversions == 0);
+}
+
+TEST_CASE("Instrumentation counts flattened conversions",
+          "[polymorphic_value.instrumentation]") {
+  reset_instrumentation<InstrBase>();
+
+  polymorphic_value<InstrDerived> p =
+      make_polymorphic_value<InstrDerived, InstrMoreDerived>(2);
+  polymorphic_value<InstrBase> q(std::move(p));
+
+  instrumentation_stats stats = instrumentation_snapshot<InstrBase>();
+  CHECK(stats.control_block_allocations == 1);
+  CHECK(stats.flattened_conversions == 1);
+}
+
+TEST_CASE("Instrumentation reset clears counters",
+          "[polymorphic_value.instrumentation]") {
+  polymorphic_value<InstrBase> p =
+      make_polymorphic_value<InstrBase, InstrDerived>(3);
+
+  reset_instrumentation<InstrBase>();
+
+  instrumentation_stats stats = instrumentation_snapshot<InstrBase>();
+  CHECK(stats.control_block_allocations == 0);
+  CHECK(stats.clone_calls == 0);
+  CHECK(stats.bytes_allocated == 0);
+}
+
+TEST_CASE("Instrumentation hook observes allocate, clone and destroy",
+          "[polymorphic_value.instrumentation]") {
+  hook_allocates = hook_clones = hook_destroys = 0;
+  set_instrumentation_hook(&counting_hook);
+
+  {
+    polymorphic_value<InstrBase> p =
+        make_polymorphic_value<InstrBase, InstrDerived>(4);
+    polymorphic_value<InstrBase> p2(p);
+  }
+
+  set_instrumentation_hook(nullptr);
+
+  CHECK(hook_allocates == 1);
+  CHECK(hook_clones == 1);
+  CHECK(hook_destroys == 2);
+}
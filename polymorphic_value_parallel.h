@@ -0,0 +1,202 @@
+/* Copyright (c) 2016 The Polymorphic Value Authors. All Rights Reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+==============================================================================*/
+
+#ifndef ISOCPP_P0201_POLYMORPHIC_VALUE_PARALLEL_H_INCLUDED
+#define ISOCPP_P0201_POLYMORPHIC_VALUE_PARALLEL_H_INCLUDED
+
+#include <cstddef>
+#include <exception>
+#include <iterator>
+#include <thread>
+#include <vector>
+
+#include "polymorphic_value.h"
+
+namespace isocpp_p0201 {
+
+namespace detail {
+
+// Shard sizes are rounded up to a whole number of cache lines of handles so
+// no two workers store to the same line when writing their output subranges.
+constexpr std::size_t parallel_shard_quantum(std::size_t element_size) {
+  return element_size >= 64 ? 1 : 64 / element_size;
+}
+
+}  // end namespace detail
+
+//
+// Parallel bulk clone
+//
+// Clones the `polymorphic_value<T>` range [first, first + n) into the
+// pre-sized random-access range starting at `out`, sharding the work across
+// `n_threads` workers. Each shard runs `clone_n`, so each worker draws its
+// control blocks from its own slab with one allocation per shard; the global
+// allocator is never contended per element. Workers write disjoint,
+// line-aligned output subranges, so no stitching pass is needed afterwards.
+// If any shard throws, its slab is released, the remaining shards finish and
+// the first exception is rethrown.
+template <class T, class ForwardIt, class RandomIt>
+RandomIt parallel_clone_n(
+    ForwardIt first, std::size_t n, RandomIt out,
+    std::size_t n_threads = std::thread::hardware_concurrency()) {
+  if (n == 0) {
+    return out;
+  }
+  if (n_threads == 0) {
+    n_threads = 1;
+  }
+
+  constexpr std::size_t quantum =
+      detail::parallel_shard_quantum(sizeof(polymorphic_value<T>));
+  std::size_t shard_size = (n + n_threads - 1) / n_threads;
+  shard_size = (shard_size + quantum - 1) / quantum * quantum;
+  if (shard_size >= n) {
+    return clone_n<T>(first, n, out);
+  }
+
+  struct shard {
+    ForwardIt first;
+    std::size_t n;
+    RandomIt out;
+  };
+
+  std::vector<shard> shards;
+  for (std::size_t offset = 0; offset != n;) {
+    const std::size_t len = offset + shard_size < n ? shard_size : n - offset;
+    shards.push_back(shard{first, len, out + offset});
+    std::advance(first, len);
+    offset += len;
+  }
+
+#if ISOCPP_P0201_HAS_EXCEPTIONS
+  std::vector<std::exception_ptr> errors(shards.size());
+#endif
+
+  auto run_shard = [&](std::size_t i) {
+#if ISOCPP_P0201_HAS_EXCEPTIONS
+    try {
+      clone_n<T>(shards[i].first, shards[i].n, shards[i].out);
+    } catch (...) {
+      errors[i] = std::current_exception();
+    }
+#else
+    clone_n<T>(shards[i].first, shards[i].n, shards[i].out);
+#endif
+  };
+
+  std::vector<std::thread> workers;
+  workers.reserve(shards.size() - 1);
+#if ISOCPP_P0201_HAS_EXCEPTIONS
+  try {
+#endif
+    for (std::size_t i = 1; i != shards.size(); ++i) {
+      workers.emplace_back(run_shard, i);
+    }
+#if ISOCPP_P0201_HAS_EXCEPTIONS
+  } catch (...) {
+    // Thread construction failed partway; destroying joinable threads
+    // would terminate, so wait for the spawned shards before propagating.
+    for (std::thread& worker : workers) {
+      worker.join();
+    }
+    throw;
+  }
+#endif
+  run_shard(0);
+  for (std::thread& worker : workers) {
+    worker.join();
+  }
+
+#if ISOCPP_P0201_HAS_EXCEPTIONS
+  for (std::exception_ptr& error : errors) {
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+#endif
+
+  return out + n;
+}
+
+//
+// Parallel bulk destroy
+//
+// Resets the `polymorphic_value` range [first, first + n) to empty, sharding
+// the element destructions (and any control-block deallocations they imply)
+// across `n_threads` workers with the same line-aligned shards as
+// `parallel_clone_n`.
+template <class RandomIt>
+void parallel_destroy_n(
+    RandomIt first, std::size_t n,
+    std::size_t n_threads = std::thread::hardware_concurrency()) {
+  using value_type = typename std::iterator_traits<RandomIt>::value_type;
+  static_assert(is_polymorphic_value<value_type>::value, "");
+
+  if (n == 0) {
+    return;
+  }
+  if (n_threads == 0) {
+    n_threads = 1;
+  }
+
+  constexpr std::size_t quantum =
+      detail::parallel_shard_quantum(sizeof(value_type));
+  std::size_t shard_size = (n + n_threads - 1) / n_threads;
+  shard_size = (shard_size + quantum - 1) / quantum * quantum;
+
+  auto run_shard = [](RandomIt shard_first, std::size_t shard_n) {
+    for (std::size_t i = 0; i != shard_n; ++i) {
+      shard_first[i] = value_type();
+    }
+  };
+
+  if (shard_size >= n) {
+    run_shard(first, n);
+    return;
+  }
+
+  std::vector<std::thread> workers;
+#if ISOCPP_P0201_HAS_EXCEPTIONS
+  try {
+#endif
+    for (std::size_t offset = shard_size; offset < n; offset += shard_size) {
+      const std::size_t len =
+          offset + shard_size < n ? shard_size : n - offset;
+      workers.emplace_back(run_shard, first + offset, len);
+    }
+#if ISOCPP_P0201_HAS_EXCEPTIONS
+  } catch (...) {
+    // As in parallel_clone_n: join the shards that did spawn before
+    // propagating the thread-construction failure.
+    for (std::thread& worker : workers) {
+      worker.join();
+    }
+    throw;
+  }
+#endif
+  run_shard(first, shard_size);
+  for (std::thread& worker : workers) {
+    worker.join();
+  }
+}
+
+}  // namespace isocpp_p0201
+
+#endif  // ISOCPP_P0201_POLYMORPHIC_VALUE_PARALLEL_H_INCLUDED
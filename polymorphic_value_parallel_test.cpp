@@ -0,0 +1,153 @@
+/* Copyright (c) 2016 The Polymorphic Value Authors. All Rights Reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+==============================================================================*/
+
+#include "polymorphic_value_parallel.h"
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+#undef CATCH_CONFIG_WINDOWS_SEH
+#include "catch2/catch_test_macros.hpp"
+
+using namespace isocpp_p0201;
+
+namespace {
+struct Node {
+  virtual int value() const = 0;
+  virtual ~Node() = default;
+};
+
+struct IntNode : Node {
+  int value_ = 0;
+
+  IntNode(int v) : value_(v) { ++object_count; }
+
+  IntNode(const IntNode& n) : value_(n.value_) { ++object_count; }
+
+  ~IntNode() { --object_count; }
+
+  int value() const override { return value_; }
+
+  static std::atomic<int> object_count;
+};
+
+std::atomic<int> IntNode::object_count{0};
+
+struct ThrowingNode : Node {
+  ThrowingNode() = default;
+
+  ThrowingNode(const ThrowingNode&) {
+    throw std::runtime_error("ThrowingNode copy");
+  }
+
+  int value() const override { return 0; }
+};
+
+}  // namespace
+
+TEST_CASE("parallel_clone_n deep-copies across workers",
+          "[polymorphic_value.parallel]") {
+  constexpr int n = 1000;
+  std::vector<polymorphic_value<Node>> source;
+  for (int i = 0; i != n; ++i) {
+    if (i % 7 == 0) {
+      source.push_back(polymorphic_value<Node>());
+    } else {
+      source.push_back(make_polymorphic_value<Node, IntNode>(i));
+    }
+  }
+
+  {
+    std::vector<polymorphic_value<Node>> copies(source.size());
+    auto end =
+        parallel_clone_n<Node>(source.begin(), source.size(), copies.begin(), 4);
+
+    REQUIRE(end == copies.end());
+    for (int i = 0; i != n; ++i) {
+      if (i % 7 == 0) {
+        CHECK(!bool(copies[i]));
+      } else {
+        REQUIRE(bool(copies[i]));
+        CHECK(copies[i]->value() == i);
+        CHECK(copies[i].operator->() != source[i].operator->());
+      }
+    }
+  }
+
+  source.clear();
+  CHECK(IntNode::object_count == 0);
+}
+
+TEST_CASE("parallel_clone_n handles small ranges and one thread",
+          "[polymorphic_value.parallel]") {
+  std::vector<polymorphic_value<Node>> source;
+  source.push_back(make_polymorphic_value<Node, IntNode>(1));
+  source.push_back(make_polymorphic_value<Node, IntNode>(2));
+
+  std::vector<polymorphic_value<Node>> copies(source.size());
+  parallel_clone_n<Node>(source.begin(), source.size(), copies.begin(), 8);
+  CHECK(copies[0]->value() == 1);
+  CHECK(copies[1]->value() == 2);
+
+  parallel_clone_n<Node>(source.begin(), source.size(), copies.begin(), 1);
+  CHECK(copies[1]->value() == 2);
+
+  CHECK(parallel_clone_n<Node>(source.begin(), 0, copies.begin(), 4) ==
+        copies.begin());
+}
+
+TEST_CASE("parallel_clone_n rethrows a worker's exception",
+          "[polymorphic_value.parallel]") {
+  std::vector<polymorphic_value<Node>> source;
+  for (int i = 0; i != 200; ++i) {
+    source.push_back(make_polymorphic_value<Node, IntNode>(i));
+  }
+  source.push_back(
+      polymorphic_value<Node>(std::in_place_type<ThrowingNode>));
+
+  std::vector<polymorphic_value<Node>> copies(source.size());
+  CHECK_THROWS_AS(parallel_clone_n<Node>(source.begin(), source.size(),
+                                         copies.begin(), 4),
+                  std::runtime_error);
+
+  source.clear();
+  copies.clear();
+  CHECK(IntNode::object_count == 0);
+}
+
+TEST_CASE("parallel_destroy_n empties the range",
+          "[polymorphic_value.parallel]") {
+  constexpr int n = 500;
+  std::vector<polymorphic_value<Node>> values;
+  for (int i = 0; i != n; ++i) {
+    values.push_back(make_polymorphic_value<Node, IntNode>(i));
+  }
+  REQUIRE(IntNode::object_count == n);
+
+  parallel_destroy_n(values.begin(), values.size(), 4);
+
+  CHECK(IntNode::object_count == 0);
+  for (const auto& value : values) {
+    CHECK(!bool(value));
+  }
+
+  parallel_destroy_n(values.begin(), 0, 4);
+}
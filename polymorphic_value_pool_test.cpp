@@ -0,0 +1,154 @@
+/* Copyright (c) 2016 The Polymorphic Value Authors. All Rights Reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+==============================================================================*/
+
+// Exercises the opt-in thread-local control-block pool. The types in this
+// translation unit are deliberately local to it so that the pooled
+// control-block instantiations are not shared with translation units compiled
+// without the pool.
+#define ISOCPP_P0201_POLYMORPHIC_VALUE_USE_CONTROL_BLOCK_POOL
+#include "polymorphic_value.h"
+
+#include <cstdint>
+#include <utility>
+
+#undef CATCH_CONFIG_WINDOWS_SEH
+#include "catch2/catch_test_macros.hpp"
+
+using namespace isocpp_p0201;
+
+namespace {
+struct PoolBase {
+  virtual int value() const = 0;
+  virtual ~PoolBase() = default;
+};
+
+struct PoolDerived : PoolBase {
+  int value_ = 0;
+
+  PoolDerived(int v) : value_(v) { ++object_count; }
+
+  PoolDerived(const PoolDerived& d) : value_(d.value_) { ++object_count; }
+
+  ~PoolDerived() { --object_count; }
+
+  int value() const override { return value_; }
+
+  static size_t object_count;
+};
+
+size_t PoolDerived::object_count = 0;
+
+}  // namespace
+
+TEST_CASE("Pooled control blocks preserve value semantics",
+          "[polymorphic_value.pool]") {
+  REQUIRE(PoolDerived::object_count == 0);
+  {
+    auto p = make_polymorphic_value<PoolBase, PoolDerived>(7);
+    auto q = p;
+
+    REQUIRE(p->value() == 7);
+    REQUIRE(q->value() == 7);
+    REQUIRE(q.operator->() != p.operator->());
+    REQUIRE(PoolDerived::object_count == 2);
+  }
+  REQUIRE(PoolDerived::object_count == 0);
+
+  flush_control_block_pool();
+}
+
+TEST_CASE("Destroyed control blocks are recycled by the pool",
+          "[polymorphic_value.pool]") {
+  flush_control_block_pool();
+
+  const void* first;
+  {
+    auto p = make_polymorphic_value<PoolBase, PoolDerived>(1);
+    first = p.operator->();
+  }
+
+  // The freed control block heads the thread-local free list, so an
+  // allocation of the same size class reuses its memory.
+  {
+    auto p = make_polymorphic_value<PoolBase, PoolDerived>(2);
+    REQUIRE(p.operator->() == first);
+    REQUIRE(p->value() == 2);
+  }
+
+  flush_control_block_pool();
+}
+
+TEST_CASE("Clone draws from the pool", "[polymorphic_value.pool]") {
+  flush_control_block_pool();
+
+  auto p = make_polymorphic_value<PoolBase, PoolDerived>(1);
+
+  const void* recycled;
+  {
+    auto q = p;
+    recycled = q.operator->();
+  }
+  {
+    auto q = p;
+    REQUIRE(q.operator->() == recycled);
+    REQUIRE(q->value() == 1);
+  }
+
+  flush_control_block_pool();
+}
+
+TEST_CASE("Pool flush releases memory and later allocations still work",
+          "[polymorphic_value.pool]") {
+  { auto p = make_polymorphic_value<PoolBase, PoolDerived>(1); }
+
+  flush_control_block_pool();
+  flush_control_block_pool();  // idempotent
+
+  auto p = make_polymorphic_value<PoolBase, PoolDerived>(3);
+  REQUIRE(p->value() == 3);
+
+  flush_control_block_pool();
+}
+
+namespace {
+struct alignas(64) PoolAlignedDerived : PoolBase {
+  int value_ = 0;
+
+  PoolAlignedDerived(int v) : value_(v) {}
+
+  int value() const override { return value_; }
+};
+
+bool aligned_to(const void* p, std::size_t align) {
+  return reinterpret_cast<std::uintptr_t>(p) % align == 0;
+}
+}  // namespace
+
+TEST_CASE("Over-aligned payloads bypass the pool and stay aligned",
+          "[polymorphic_value.pool]") {
+  auto p = make_polymorphic_value<PoolBase, PoolAlignedDerived>(1);
+  REQUIRE(aligned_to(p.operator->(), 64));
+
+  auto q = p;
+  REQUIRE(aligned_to(q.operator->(), 64));
+  REQUIRE(q->value() == 1);
+
+  flush_control_block_pool();
+}
@@ -0,0 +1,274 @@
+/* Copyright (c) 2016 The Polymorphic Value Authors. All Rights Reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+==============================================================================*/
+
+#ifndef ISOCPP_P0201_POLYMORPHIC_VALUE_SERIALIZATION_H_INCLUDED
+#define ISOCPP_P0201_POLYMORPHIC_VALUE_SERIALIZATION_H_INCLUDED
+
+#include <cstdint>
+#include <exception>
+#include <istream>
+#include <iterator>
+#include <new>
+#include <ostream>
+#include <typeinfo>
+#include <vector>
+
+#include "polymorphic_value.h"
+
+namespace isocpp_p0201 {
+
+////////////////////////////////////////////////////////////////////////////////
+// Streaming serialization for ranges of `polymorphic_value<T>`.
+//
+// Concrete types register a small integer tag with per-type save/load
+// functions in `serialization_registry<T>`. `save` writes a range as a
+// length-prefixed stream (count, then all tags, then all payloads, in native
+// byte order); putting the tags before the payloads lets `load` size one
+// slab for every control block up front, so restoring N values costs one
+// allocation plus a linear pass instead of one `new` per element.
+////////////////////////////////////////////////////////////////////////////////
+
+class bad_polymorphic_value_serialization : public std::exception {
+ public:
+  const char* what() const noexcept override {
+    return "bad_polymorphic_value_serialization";
+  }
+};
+
+namespace detail {
+
+// Tag reserved for an empty `polymorphic_value`.
+constexpr std::uint32_t empty_value_tag = 0xFFFFFFFF;
+
+template <class V>
+void write_raw(std::ostream& os, const V& v) {
+  os.write(reinterpret_cast<const char*>(&v), sizeof(V));
+  if (!os) {
+    throw bad_polymorphic_value_serialization();
+  }
+}
+
+template <class V>
+V read_raw(std::istream& is) {
+  V v;
+  is.read(reinterpret_cast<char*>(&v), sizeof(V));
+  if (!is) {
+    throw bad_polymorphic_value_serialization();
+  }
+  return v;
+}
+
+// Type-erasing trampolines over the user-registered functions for one
+// concrete type `U`.
+template <class T, class U>
+struct serialization_functions {
+  static void (*save_fn)(std::ostream&, const U&);
+  static U (*load_fn)(std::istream&);
+
+  static void save_thunk(std::ostream& os, const T& t) {
+    save_fn(os, static_cast<const U&>(t));
+  }
+
+  static control_block<T>* load_thunk(void* storage, bulk_arena_header* arena,
+                                      std::istream& is) {
+    return ::new (storage)
+        arena_direct_control_block<T, U>(load_fn(is), arena);
+  }
+};
+
+template <class T, class U>
+void (*serialization_functions<T, U>::save_fn)(std::ostream&,
+                                               const U&) = nullptr;
+
+template <class T, class U>
+U (*serialization_functions<T, U>::load_fn)(std::istream&) = nullptr;
+
+}  // end namespace detail
+
+////////////////////////////////////////////////////////////////////////////////
+// `serialization_registry` class definition
+////////////////////////////////////////////////////////////////////////////////
+
+// The factory table for erased type `T`, keyed by tag for loading and by
+// dynamic type for saving. Registration is not thread-safe; register every
+// type during start-up, before the first `save` or `load`.
+template <class T>
+class serialization_registry {
+ public:
+  struct entry {
+    std::uint32_t tag;
+    const std::type_info* type;
+    std::size_t block_size;
+    void (*save)(std::ostream&, const T&);
+    detail::control_block<T>* (*load_into)(void* storage,
+                                           detail::bulk_arena_header* arena,
+                                           std::istream& is);
+  };
+
+  // Registers `U` under `tag` with its save/load functions. Throws
+  // `bad_polymorphic_value_serialization` if the tag is already taken.
+  template <class U>
+  static void register_type(std::uint32_t tag,
+                            void (*save)(std::ostream&, const U&),
+                            U (*load)(std::istream&)) {
+    static_assert(std::is_convertible<U*, T*>::value, "");
+    static_assert(alignof(detail::arena_direct_control_block<T, U>) <=
+                      alignof(std::max_align_t),
+                  "over-aligned types are not supported by the load arena");
+    if (tag == detail::empty_value_tag || find_tag(tag) != nullptr) {
+      throw bad_polymorphic_value_serialization();
+    }
+    detail::serialization_functions<T, U>::save_fn = save;
+    detail::serialization_functions<T, U>::load_fn = load;
+    entries().push_back(
+        entry{tag, &typeid(U),
+              sizeof(detail::arena_direct_control_block<T, U>),
+              &detail::serialization_functions<T, U>::save_thunk,
+              &detail::serialization_functions<T, U>::load_thunk});
+  }
+
+  static const entry* find_tag(std::uint32_t tag) {
+    for (const entry& e : entries()) {
+      if (e.tag == tag) {
+        return &e;
+      }
+    }
+    return nullptr;
+  }
+
+  static const entry* find_type(const std::type_info& type) {
+    for (const entry& e : entries()) {
+      if (*e.type == type) {
+        return &e;
+      }
+    }
+    return nullptr;
+  }
+
+ private:
+  static std::vector<entry>& entries() {
+    static std::vector<entry> entries;
+    return entries;
+  }
+};
+
+//
+// Range save / load
+//
+
+// Writes [first, last) to `os`. Throws `bad_polymorphic_value_serialization`
+// for values whose dynamic type has not been registered or on stream failure.
+template <class T, class ForwardIt>
+void save(std::ostream& os, ForwardIt first, ForwardIt last) {
+  using registry = serialization_registry<T>;
+
+  const std::uint64_t count =
+      static_cast<std::uint64_t>(std::distance(first, last));
+  detail::write_raw(os, count);
+
+  for (ForwardIt it = first; it != last; ++it) {
+    const polymorphic_value<T>& src = *it;
+    if (!src) {
+      detail::write_raw(os, detail::empty_value_tag);
+      continue;
+    }
+    const typename registry::entry* e = registry::find_type(typeid(*src));
+    if (!e) {
+      throw bad_polymorphic_value_serialization();
+    }
+    detail::write_raw(os, e->tag);
+  }
+
+  for (; first != last; ++first) {
+    const polymorphic_value<T>& src = *first;
+    if (src) {
+      registry::find_type(typeid(*src))->save(os, *src);
+    }
+  }
+}
+
+// Reads a stream written by `save` and emits the restored values to `out`.
+// All control blocks are placement-constructed in one refcounted slab, freed
+// when the last restored value is destroyed.
+template <class T, class OutputIt>
+OutputIt load(std::istream& is, OutputIt out) {
+  using registry = serialization_registry<T>;
+  constexpr std::size_t align = alignof(std::max_align_t);
+  const auto align_up = [](std::size_t offset) {
+    return (offset + align - 1) & ~(align - 1);
+  };
+
+  const std::uint64_t count = detail::read_raw<std::uint64_t>(is);
+
+  std::vector<const typename registry::entry*> plan;
+  plan.reserve(static_cast<std::size_t>(count));
+  std::size_t total = 0;
+  for (std::uint64_t i = 0; i != count; ++i) {
+    const std::uint32_t tag = detail::read_raw<std::uint32_t>(is);
+    if (tag == detail::empty_value_tag) {
+      plan.push_back(nullptr);
+      continue;
+    }
+    const typename registry::entry* e = registry::find_tag(tag);
+    if (!e) {
+      throw bad_polymorphic_value_serialization();
+    }
+    total = align_up(total) + e->block_size;
+    plan.push_back(e);
+  }
+
+  detail::bulk_arena_header* arena = nullptr;
+  unsigned char* data = nullptr;
+  if (total != 0) {
+    constexpr std::size_t header_size =
+        (sizeof(detail::bulk_arena_header) + align - 1) & ~(align - 1);
+    void* raw = ::operator new(header_size + total);
+    arena = ::new (raw) detail::bulk_arena_header();
+    data = static_cast<unsigned char*>(raw) + header_size;
+  }
+
+  std::size_t offset = 0;
+  try {
+    for (const typename registry::entry* e : plan) {
+      if (!e) {
+        *out++ = polymorphic_value<T>();
+        continue;
+      }
+      offset = align_up(offset);
+      detail::control_block<T>* cb = e->load_into(data + offset, arena, is);
+      offset += e->block_size;
+      arena->retain();
+      *out++ = detail::adopt_control_block(cb);
+    }
+  } catch (...) {
+    if (arena) {
+      detail::bulk_arena_header::release(arena);
+    }
+    throw;
+  }
+  if (arena) {
+    detail::bulk_arena_header::release(arena);
+  }
+  return out;
+}
+
+}  // namespace isocpp_p0201
+
+#endif  // ISOCPP_P0201_POLYMORPHIC_VALUE_SERIALIZATION_H_INCLUDED
@@ -0,0 +1,174 @@
+/* Copyright (c) 2016 The Polymorphic Value Authors. All Rights Reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+==============================================================================*/
+
+#include "polymorphic_value_serialization.h"
+
+#include <cstdlib>
+#include <iterator>
+#include <sstream>
+#include <vector>
+
+#undef CATCH_CONFIG_WINDOWS_SEH
+#include "catch2/catch_test_macros.hpp"
+
+using namespace isocpp_p0201;
+
+namespace {
+struct Shape {
+  virtual int area() const = 0;
+  virtual ~Shape() = default;
+};
+
+struct Square : Shape {
+  int side_ = 0;
+
+  Square(int side) : side_(side) {}
+
+  int area() const override { return side_ * side_; }
+
+  static void save(std::ostream& os, const Square& s) {
+    detail::write_raw(os, s.side_);
+  }
+
+  static Square load(std::istream& is) {
+    return Square(detail::read_raw<int>(is));
+  }
+};
+
+struct Rectangle : Shape {
+  int width_ = 0;
+  int height_ = 0;
+
+  Rectangle(int w, int h) : width_(w), height_(h) {}
+
+  int area() const override { return width_ * height_; }
+
+  static void save(std::ostream& os, const Rectangle& r) {
+    detail::write_raw(os, r.width_);
+    detail::write_raw(os, r.height_);
+  }
+
+  static Rectangle load(std::istream& is) {
+    const int w = detail::read_raw<int>(is);
+    const int h = detail::read_raw<int>(is);
+    return Rectangle(w, h);
+  }
+};
+
+struct Circle : Shape {
+  int radius_ = 0;
+
+  Circle(int r) : radius_(r) {}
+
+  int area() const override { return 3 * radius_ * radius_; }
+};
+
+bool register_shapes() {
+  serialization_registry<Shape>::register_type<Square>(1, &Square::save,
+                                                       &Square::load);
+  serialization_registry<Shape>::register_type<Rectangle>(2, &Rectangle::save,
+                                                          &Rectangle::load);
+  return true;
+}
+
+const bool shapes_registered = register_shapes();
+
+}  // namespace
+
+TEST_CASE("Serialization round-trips a mixed range",
+          "[polymorphic_value.serialization]") {
+  REQUIRE(shapes_registered);
+
+  std::vector<polymorphic_value<Shape>> shapes;
+  shapes.push_back(make_polymorphic_value<Shape, Square>(3));
+  shapes.push_back(polymorphic_value<Shape>());
+  shapes.push_back(make_polymorphic_value<Shape, Rectangle>(4, 5));
+  shapes.push_back(make_polymorphic_value<Shape, Square>(6));
+
+  std::stringstream stream;
+  save<Shape>(stream, shapes.begin(), shapes.end());
+
+  std::vector<polymorphic_value<Shape>> restored;
+  load<Shape>(stream, std::back_inserter(restored));
+
+  REQUIRE(restored.size() == 4);
+  CHECK(restored[0]->area() == 9);
+  CHECK(!bool(restored[1]));
+  CHECK(restored[2]->area() == 20);
+  CHECK(restored[3]->area() == 36);
+}
+
+TEST_CASE("Loaded control blocks share one slab",
+          "[polymorphic_value.serialization]") {
+  std::vector<polymorphic_value<Shape>> shapes;
+  for (int i = 0; i != 16; ++i) {
+    shapes.push_back(make_polymorphic_value<Shape, Square>(i));
+  }
+
+  std::stringstream stream;
+  save<Shape>(stream, shapes.begin(), shapes.end());
+
+  std::vector<polymorphic_value<Shape>> restored;
+  load<Shape>(stream, std::back_inserter(restored));
+
+  REQUIRE(restored.size() == 16);
+  const char* first = reinterpret_cast<const char*>(restored.front().operator->());
+  const char* last = reinterpret_cast<const char*>(restored.back().operator->());
+  CHECK(static_cast<size_t>(std::abs(last - first)) < 16 * 256);
+
+  // Partial destruction keeps the rest of the slab valid.
+  restored.resize(8);
+  CHECK(restored[7]->area() == 49);
+}
+
+TEST_CASE("Saving an unregistered type fails",
+          "[polymorphic_value.serialization]") {
+  std::vector<polymorphic_value<Shape>> shapes;
+  shapes.push_back(make_polymorphic_value<Shape, Circle>(1));
+
+  std::stringstream stream;
+  CHECK_THROWS_AS(save<Shape>(stream, shapes.begin(), shapes.end()),
+                  bad_polymorphic_value_serialization);
+}
+
+TEST_CASE("Loading an unknown tag or truncated stream fails",
+          "[polymorphic_value.serialization]") {
+  std::stringstream unknown;
+  detail::write_raw(unknown, std::uint64_t{1});
+  detail::write_raw(unknown, std::uint32_t{99});
+
+  std::vector<polymorphic_value<Shape>> restored;
+  CHECK_THROWS_AS(load<Shape>(unknown, std::back_inserter(restored)),
+                  bad_polymorphic_value_serialization);
+
+  std::stringstream truncated;
+  detail::write_raw(truncated, std::uint64_t{2});
+  detail::write_raw(truncated, std::uint32_t{1});
+
+  CHECK_THROWS_AS(load<Shape>(truncated, std::back_inserter(restored)),
+                  bad_polymorphic_value_serialization);
+}
+
+TEST_CASE("Duplicate tag registration fails",
+          "[polymorphic_value.serialization]") {
+  CHECK_THROWS_AS(serialization_registry<Shape>::register_type<Square>(
+                      1, &Square::save, &Square::load),
+                  bad_polymorphic_value_serialization);
+}
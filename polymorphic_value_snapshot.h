@@ -0,0 +1,367 @@
+/* Copyright (c) 2016 The Polymorphic Value Authors. All Rights Reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+==============================================================================*/
+
+#ifndef ISOCPP_P0201_POLYMORPHIC_VALUE_SNAPSHOT_H_INCLUDED
+#define ISOCPP_P0201_POLYMORPHIC_VALUE_SNAPSHOT_H_INCLUDED
+
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <vector>
+
+#include "polymorphic_value.h"
+#include "polymorphic_value_serialization.h"
+
+namespace isocpp_p0201 {
+
+////////////////////////////////////////////////////////////////////////////////
+// Flat snapshot images for ranges of `polymorphic_value<T>`.
+//
+// A snapshot is a relocatable byte image: payloads laid out contiguously,
+// addressed by offsets, and identified by registered integer tags rather
+// than vtable pointers. `snapshot_builder` lays out and writes the image;
+// `load_snapshot` materializes handles over a writable mapping of it (for
+// example a MAP_PRIVATE mmap of the file) without copying or constructing
+// payloads — per element it patches one vtable word and placement-constructs
+// a small control block in a single shared slab, so start-up cost is the map
+// plus page faults instead of an allocation and constructor per object.
+//
+// Handles returned by `load_snapshot` read the mapped bytes in place; the
+// mapping must stay valid until the last of them (and anything moved from
+// them) is destroyed. Copying a handle leaves the image untouched and
+// deep-copies the payload onto the heap through the normal `clone()` path,
+// and writes through a handle dirty only the mapped page, so mutation is
+// copy-on-write at both levels.
+//
+// Registered payload types must be trivially relocatable (specialize
+// `is_trivially_relocatable`), keep their vtable pointer as their first
+// word (single polymorphic base, no virtual bases) and own no external
+// resources: snapshot payload destructors are never run.
+////////////////////////////////////////////////////////////////////////////////
+
+namespace detail {
+
+constexpr std::uint64_t snapshot_magic = 0x50303230314E5053;  // "P0201NPS"
+
+// Payload offsets are image-absolute; the payload region is aligned to this
+// boundary within the image, so payload alignment holds whenever the mapping
+// itself is at least this aligned (mmap returns page-aligned memory).
+constexpr std::size_t snapshot_region_align = 64;
+
+template <class T>
+class snapshot_control_block;
+
+}  // end namespace detail
+
+////////////////////////////////////////////////////////////////////////////////
+// `snapshot_registry` class definition
+////////////////////////////////////////////////////////////////////////////////
+
+// The layout table for erased type `T`, keyed by tag for loading and by the
+// control block's payload identity for building. Registration is not
+// thread-safe; register every type during start-up, before the first build
+// or load.
+template <class T>
+class snapshot_registry {
+ public:
+  struct entry {
+    std::uint32_t tag;
+    const void* payload_key;
+    std::size_t size;
+    std::size_t align;
+    std::uintptr_t vtable_word;
+    detail::control_block<T>* (*clone_heap)(const void* payload);
+    T* (*as_interface)(void* payload);
+  };
+
+  // Registers `U` under `tag`. The exemplar supplies the vtable word that
+  // `load_snapshot` patches into each stored payload; its dynamic type must
+  // be exactly `U`. Throws `bad_polymorphic_value_serialization` if the tag
+  // is already taken.
+  template <class U>
+  static void register_type(std::uint32_t tag, const U& exemplar) {
+    static_assert(std::is_convertible<U*, T*>::value, "");
+    static_assert(is_trivially_relocatable<U>::value,
+                  "snapshot payloads are stored and revived by memcpy");
+    if (tag == detail::empty_value_tag || find_tag(tag) != nullptr) {
+      throw bad_polymorphic_value_serialization();
+    }
+    entries().push_back(entry{tag, detail::payload_type_key<U>(), sizeof(U),
+                              alignof(U),
+                              detail::vptr_word(std::addressof(exemplar)),
+                              &clone_heap_thunk<U>, &as_interface_thunk<U>});
+  }
+
+  static const entry* find_tag(std::uint32_t tag) {
+    for (const entry& e : entries()) {
+      if (e.tag == tag) {
+        return &e;
+      }
+    }
+    return nullptr;
+  }
+
+  static const entry* find_key(const void* payload_key) {
+    for (const entry& e : entries()) {
+      if (e.payload_key == payload_key) {
+        return &e;
+      }
+    }
+    return nullptr;
+  }
+
+ private:
+  template <class U>
+  static detail::control_block<T>* clone_heap_thunk(const void* payload) {
+    return new detail::direct_control_block<T, U>(
+        *static_cast<const U*>(payload));
+  }
+
+  template <class U>
+  static T* as_interface_thunk(void* payload) {
+    return static_cast<U*>(payload);
+  }
+
+  static std::vector<entry>& entries() {
+    static std::vector<entry> entries;
+    return entries;
+  }
+};
+
+namespace detail {
+
+// Control block for one payload living in a snapshot image. Blocks share a
+// refcounted slab (one allocation per load) and never destroy or free their
+// payload; clones leave the image and go to the heap as ordinary direct
+// blocks.
+template <class T>
+class snapshot_control_block final : public control_block<T> {
+  T* t_;
+  void* payload_;
+  const typename snapshot_registry<T>::entry* entry_;
+  bulk_arena_header* slab_;
+
+ public:
+  explicit snapshot_control_block(
+      void* payload, const typename snapshot_registry<T>::entry* entry,
+      bulk_arena_header* slab)
+      : t_(entry->as_interface(payload)),
+        payload_(payload),
+        entry_(entry),
+        slab_(slab) {}
+
+  std::unique_ptr<control_block<T>, control_block_deleter> clone()
+      const override {
+    return std::unique_ptr<control_block<T>, control_block_deleter>(
+        entry_->clone_heap(payload_));
+  }
+
+  T* ptr() override { return t_; }
+
+  void* object_address() noexcept override { return payload_; }
+
+  const void* payload_key() const noexcept override {
+    return entry_->payload_key;
+  }
+
+  void destroy() noexcept override {
+    bulk_arena_header* slab = slab_;
+    this->~snapshot_control_block();
+    bulk_arena_header::release(slab);
+  }
+};
+
+}  // end namespace detail
+
+////////////////////////////////////////////////////////////////////////////////
+// `snapshot_builder` class definition
+////////////////////////////////////////////////////////////////////////////////
+
+template <class T>
+class snapshot_builder {
+ public:
+  // Appends one value to the image. Throws
+  // `bad_polymorphic_value_serialization` for payloads whose type has not
+  // been registered (including any not created in place, whose dynamic type
+  // the control block cannot vouch for).
+  void add(const polymorphic_value<T>& p) {
+    if (!p) {
+      elements_.push_back(element{detail::empty_value_tag, 0});
+      return;
+    }
+    const detail::control_block<T>* cb = detail::get_control_block(p);
+    const typename snapshot_registry<T>::entry* e =
+        snapshot_registry<T>::find_key(cb->payload_key());
+    if (!e) {
+      throw bad_polymorphic_value_serialization();
+    }
+
+    payload_bytes_.resize((payload_bytes_.size() + e->align - 1) /
+                          e->align * e->align);
+    const std::uint64_t offset = payload_bytes_.size();
+    payload_bytes_.resize(payload_bytes_.size() + e->size);
+    std::memcpy(payload_bytes_.data() + offset,
+                const_cast<detail::control_block<T>*>(cb)->object_address(),
+                e->size);
+    elements_.push_back(element{e->tag, offset});
+  }
+
+  // Writes the image: magic, count, payload-region size, the element table
+  // ({tag, image-absolute payload offset} per element), padding to the
+  // aligned payload region, then the payload bytes.
+  void save(std::ostream& os) const {
+    const std::uint64_t header_size =
+        3 * sizeof(std::uint64_t) + elements_.size() * 2 * sizeof(std::uint64_t);
+    const std::uint64_t region_base =
+        (header_size + detail::snapshot_region_align - 1) /
+        detail::snapshot_region_align * detail::snapshot_region_align;
+
+    detail::write_raw(os, detail::snapshot_magic);
+    detail::write_raw(os, static_cast<std::uint64_t>(elements_.size()));
+    detail::write_raw(os,
+                      static_cast<std::uint64_t>(payload_bytes_.size()));
+    for (const element& e : elements_) {
+      detail::write_raw(os, static_cast<std::uint64_t>(e.tag));
+      detail::write_raw(os, e.tag == detail::empty_value_tag
+                                ? std::uint64_t{0}
+                                : region_base + e.offset);
+    }
+    for (std::uint64_t i = header_size; i != region_base; ++i) {
+      detail::write_raw(os, static_cast<unsigned char>(0));
+    }
+    os.write(reinterpret_cast<const char*>(payload_bytes_.data()),
+             static_cast<std::streamsize>(payload_bytes_.size()));
+    if (!os) {
+      throw bad_polymorphic_value_serialization();
+    }
+  }
+
+ private:
+  struct element {
+    std::uint32_t tag;
+    std::uint64_t offset;
+  };
+
+  std::vector<element> elements_;
+  std::vector<unsigned char> payload_bytes_;
+};
+
+//
+// Image load
+//
+
+// Materializes `polymorphic_value<T>` handles over a writable snapshot image
+// of `image_size` bytes, emitting them to `out`. The image must be aligned
+// to `detail::snapshot_region_align` (any mmap is) and must stay valid until
+// every emitted handle is destroyed; see the header comment for the full
+// lifetime and copy-on-write contract. Throws
+// `bad_polymorphic_value_serialization` on a malformed image or an
+// unregistered tag.
+template <class T, class OutputIt>
+OutputIt load_snapshot(void* image, std::size_t image_size, OutputIt out) {
+  using registry = snapshot_registry<T>;
+  using block_type = detail::snapshot_control_block<T>;
+  static_assert(alignof(block_type) <= alignof(std::max_align_t), "");
+
+  unsigned char* bytes = static_cast<unsigned char*>(image);
+  const std::uint64_t header_min = 3 * sizeof(std::uint64_t);
+  if (image_size < header_min) {
+    throw bad_polymorphic_value_serialization();
+  }
+
+  std::uint64_t magic;
+  std::uint64_t count;
+  std::memcpy(&magic, bytes, sizeof(magic));
+  std::memcpy(&count, bytes + sizeof(std::uint64_t), sizeof(count));
+  if (magic != detail::snapshot_magic ||
+      count > (image_size - header_min) / (2 * sizeof(std::uint64_t))) {
+    throw bad_polymorphic_value_serialization();
+  }
+
+  // Size one slab for every control block up front, as `load` does.
+  std::vector<std::pair<const typename registry::entry*, std::uint64_t>> plan;
+  plan.reserve(static_cast<std::size_t>(count));
+  std::size_t blocks = 0;
+  for (std::uint64_t i = 0; i != count; ++i) {
+    std::uint64_t tag;
+    std::uint64_t offset;
+    std::memcpy(&tag, bytes + header_min + i * 2 * sizeof(std::uint64_t),
+                sizeof(tag));
+    std::memcpy(&offset,
+                bytes + header_min + (i * 2 + 1) * sizeof(std::uint64_t),
+                sizeof(offset));
+    if (tag == detail::empty_value_tag) {
+      plan.emplace_back(nullptr, 0);
+      continue;
+    }
+    const typename registry::entry* e =
+        registry::find_tag(static_cast<std::uint32_t>(tag));
+    if (!e || offset + e->size > image_size) {
+      throw bad_polymorphic_value_serialization();
+    }
+    plan.emplace_back(e, offset);
+    ++blocks;
+  }
+
+  detail::bulk_arena_header* slab = nullptr;
+  unsigned char* block_storage = nullptr;
+  if (blocks != 0) {
+    constexpr std::size_t header_size =
+        (sizeof(detail::bulk_arena_header) + alignof(std::max_align_t) - 1) &
+        ~(alignof(std::max_align_t) - 1);
+    void* raw = ::operator new(header_size + blocks * sizeof(block_type));
+    slab = ::new (raw) detail::bulk_arena_header();
+    block_storage = static_cast<unsigned char*>(raw) + header_size;
+  }
+
+  try {
+    for (const auto& planned : plan) {
+      const typename registry::entry* e = planned.first;
+      if (!e) {
+        *out++ = polymorphic_value<T>();
+        continue;
+      }
+      unsigned char* payload = bytes + planned.second;
+      // Revive the payload in place: its data bytes are already laid out,
+      // and installing the registered vtable word makes it a live object
+      // again.
+      std::memcpy(payload, &e->vtable_word, sizeof(e->vtable_word));
+      block_type* cb = ::new (block_storage) block_type(payload, e, slab);
+      block_storage += sizeof(block_type);
+      slab->retain();
+      *out++ = detail::adopt_control_block(cb);
+    }
+  } catch (...) {
+    // A throwing output iterator must not leak the slab: drop the creating
+    // reference and let the handles already emitted keep it alive.
+    if (slab) {
+      detail::bulk_arena_header::release(slab);
+    }
+    throw;
+  }
+  if (slab) {
+    detail::bulk_arena_header::release(slab);
+  }
+  return out;
+}
+
+}  // namespace isocpp_p0201
+
+#endif  // ISOCPP_P0201_POLYMORPHIC_VALUE_SNAPSHOT_H_INCLUDED
@@ -0,0 +1,218 @@
+/* Copyright (c) 2016 The Polymorphic Value Authors. All Rights Reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+==============================================================================*/
+
+#include "polymorphic_value_snapshot.h"
+
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#undef CATCH_CONFIG_WINDOWS_SEH
+#include "catch2/catch_test_macros.hpp"
+
+using namespace isocpp_p0201;
+
+namespace {
+struct FlatShape {
+  virtual int area() const = 0;
+  virtual void scale(int factor) = 0;
+  virtual ~FlatShape() = default;
+};
+
+struct FlatSquare : FlatShape {
+  int side_ = 0;
+
+  FlatSquare(int side) : side_(side) {}
+
+  int area() const override { return side_ * side_; }
+
+  void scale(int factor) override { side_ *= factor; }
+};
+
+struct FlatCircle : FlatShape {
+  int radius_ = 0;
+
+  FlatCircle(int r) : radius_(r) {}
+
+  int area() const override { return 3 * radius_ * radius_; }
+
+  void scale(int factor) override { radius_ *= factor; }
+};
+
+struct FlatTriangle : FlatShape {
+  int base_ = 0;
+
+  FlatTriangle(int b) : base_(b) {}
+
+  int area() const override { return base_; }
+
+  void scale(int factor) override { base_ *= factor; }
+};
+
+}  // namespace
+
+namespace isocpp_p0201 {
+template <>
+struct is_trivially_relocatable<FlatSquare> : std::true_type {};
+template <>
+struct is_trivially_relocatable<FlatCircle> : std::true_type {};
+}  // namespace isocpp_p0201
+
+namespace {
+
+bool register_flat_shapes() {
+  static const FlatSquare square_exemplar(0);
+  static const FlatCircle circle_exemplar(0);
+  snapshot_registry<FlatShape>::register_type<FlatSquare>(1, square_exemplar);
+  snapshot_registry<FlatShape>::register_type<FlatCircle>(2, circle_exemplar);
+  return true;
+}
+
+const bool flat_shapes_registered = register_flat_shapes();
+
+// A 64-aligned copy of the built image, standing in for a MAP_PRIVATE mmap.
+struct mapped_image {
+  unsigned char* bytes;
+  std::size_t size;
+
+  explicit mapped_image(const std::string& s)
+      : bytes(static_cast<unsigned char*>(::operator new(
+            s.size(), std::align_val_t(detail::snapshot_region_align)))),
+        size(s.size()) {
+    std::memcpy(bytes, s.data(), s.size());
+  }
+
+  ~mapped_image() {
+    ::operator delete(bytes,
+                      std::align_val_t(detail::snapshot_region_align));
+  }
+};
+
+std::string build_image(const std::vector<polymorphic_value<FlatShape>>& vs) {
+  snapshot_builder<FlatShape> builder;
+  for (const auto& v : vs) {
+    builder.add(v);
+  }
+  std::ostringstream os;
+  builder.save(os);
+  return os.str();
+}
+
+bool within(const void* p, const mapped_image& image) {
+  const unsigned char* c = static_cast<const unsigned char*>(p);
+  return c >= image.bytes && c < image.bytes + image.size;
+}
+
+}  // namespace
+
+TEST_CASE("Snapshot round-trips a mixed range zero-copy",
+          "[polymorphic_value.snapshot]") {
+  REQUIRE(flat_shapes_registered);
+
+  std::vector<polymorphic_value<FlatShape>> shapes;
+  shapes.push_back(make_polymorphic_value<FlatShape, FlatSquare>(3));
+  shapes.push_back(polymorphic_value<FlatShape>());
+  shapes.push_back(make_polymorphic_value<FlatShape, FlatCircle>(2));
+
+  mapped_image image(build_image(shapes));
+
+  std::vector<polymorphic_value<FlatShape>> restored;
+  load_snapshot<FlatShape>(image.bytes, image.size,
+                           std::back_inserter(restored));
+
+  REQUIRE(restored.size() == 3);
+  CHECK(restored[0]->area() == 9);
+  CHECK(!bool(restored[1]));
+  CHECK(restored[2]->area() == 12);
+
+  // Zero-copy: the payloads live in the image, not on the heap.
+  CHECK(within(restored[0].operator->(), image));
+  CHECK(within(restored[2].operator->(), image));
+}
+
+TEST_CASE("Snapshot handles copy onto the heap and mutate independently",
+          "[polymorphic_value.snapshot]") {
+  std::vector<polymorphic_value<FlatShape>> shapes;
+  shapes.push_back(make_polymorphic_value<FlatShape, FlatSquare>(4));
+
+  mapped_image image(build_image(shapes));
+
+  std::vector<polymorphic_value<FlatShape>> restored;
+  load_snapshot<FlatShape>(image.bytes, image.size,
+                           std::back_inserter(restored));
+
+  polymorphic_value<FlatShape> copy(restored[0]);
+  CHECK(!within(copy.operator->(), image));
+  CHECK(copy->area() == 16);
+
+  copy->scale(2);
+  CHECK(copy->area() == 64);
+  CHECK(restored[0]->area() == 16);
+
+  // Mutating through a snapshot handle writes the image, not the copy.
+  restored[0]->scale(3);
+  CHECK(restored[0]->area() == 144);
+  CHECK(copy->area() == 64);
+
+  // visit recognizes snapshot payloads through the shared identity key.
+  const bool matched = visit<FlatSquare>(restored[0], [](const auto& s) {
+    return std::is_same<std::decay_t<decltype(s)>, FlatSquare>::value;
+  });
+  CHECK(matched);
+}
+
+TEST_CASE("Snapshot building rejects unregistered payloads",
+          "[polymorphic_value.snapshot]") {
+  snapshot_builder<FlatShape> builder;
+
+  CHECK_THROWS_AS(
+      builder.add(make_polymorphic_value<FlatShape, FlatTriangle>(1)),
+      bad_polymorphic_value_serialization);
+
+  // Pointer-adopted values carry no payload identity and are rejected too.
+  FlatSquare* raw = new FlatSquare(1);
+  CHECK_THROWS_AS(builder.add(polymorphic_value<FlatShape>(raw)),
+                  bad_polymorphic_value_serialization);
+}
+
+TEST_CASE("Loading a malformed image fails",
+          "[polymorphic_value.snapshot]") {
+  std::vector<polymorphic_value<FlatShape>> restored;
+
+  std::string tiny("ab");
+  mapped_image small_image(tiny);
+  CHECK_THROWS_AS(load_snapshot<FlatShape>(small_image.bytes,
+                                           small_image.size,
+                                           std::back_inserter(restored)),
+                  bad_polymorphic_value_serialization);
+
+  std::vector<polymorphic_value<FlatShape>> shapes;
+  shapes.push_back(make_polymorphic_value<FlatShape, FlatSquare>(3));
+  std::string bytes = build_image(shapes);
+  bytes[0] ^= 0xFF;
+  mapped_image corrupt(bytes);
+  CHECK_THROWS_AS(load_snapshot<FlatShape>(corrupt.bytes, corrupt.size,
+                                           std::back_inserter(restored)),
+                  bad_polymorphic_value_serialization);
+}
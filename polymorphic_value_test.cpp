@@ -20,9 +20,12 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include "polymorphic_value.h"
 
+#include <iterator>
+#include <cstring>
 #include <new>
 #include <stdexcept>
 #include <utility>
+#include <vector>
 
 #undef CATCH_CONFIG_WINDOWS_SEH
 #include "catch2/catch_test_macros.hpp"
@@ -184,6 +187,57 @@ TEST_CASE("polymorphic_value constructed with copier and deleter",
   REQUIRE(deletion_count == 1);
 }
 
+TEST_CASE("polymorphic_value constructed from unique_ptr",
+          "[polymorphic_value.constructors]") {
+  GIVEN("A polymorphic_value adopted from a unique_ptr") {
+    int v = 7;
+    polymorphic_value<BaseType> cptr(std::make_unique<DerivedType>(v));
+
+    THEN("Operator-> calls the pointee method") { REQUIRE(cptr->value() == v); }
+
+    THEN("operator bool returns true") { REQUIRE((bool)cptr == true); }
+
+    WHEN("The polymorphic_value is copied") {
+      polymorphic_value<BaseType> copy(cptr);
+
+      THEN("values are distinct") {
+        REQUIRE(copy.operator->() != cptr.operator->());
+        REQUIRE(copy->value() == v);
+      }
+    }
+  }
+
+  GIVEN("An empty unique_ptr") {
+    std::unique_ptr<DerivedType> null_ptr;
+    polymorphic_value<BaseType> cptr(std::move(null_ptr));
+
+    THEN("operator bool returns false") { REQUIRE((bool)cptr == false); }
+  }
+
+  GIVEN("A unique_ptr with a custom deleter") {
+    size_t deletion_count = 0;
+    auto deleter = [&deletion_count](DerivedType* d) {
+      ++deletion_count;
+      delete d;
+    };
+
+    {
+      std::unique_ptr<DerivedType, decltype(deleter)> p(new DerivedType(7),
+                                                        deleter);
+      polymorphic_value<DerivedType> cptr(std::move(p));
+
+      WHEN("The polymorphic_value is copied and the copy destroyed") {
+        { polymorphic_value<DerivedType> copy(cptr); }
+
+        THEN("The copy is not destroyed with the adopted deleter") {
+          REQUIRE(deletion_count == 0);
+        }
+      }
+    }
+    REQUIRE(deletion_count == 1);
+  }
+}
+
 TEST_CASE("polymorphic_value destructor", "[polymorphic_value.destructor]") {
   GIVEN("No derived objects") {
     REQUIRE(DerivedType::object_count == 0);
@@ -514,6 +568,63 @@ TEST_CASE("polymorphic_value move-assignment",
   }
 }
 
+TEST_CASE("clone_n deep-copies a range into one arena",
+          "[polymorphic_value.clone_n]") {
+  REQUIRE(DerivedType::object_count == 0);
+  {
+    std::vector<polymorphic_value<BaseType>> source;
+    for (int i = 0; i < 8; ++i) {
+      source.push_back(make_polymorphic_value<BaseType, DerivedType>(i));
+    }
+
+    std::vector<polymorphic_value<BaseType>> copies;
+    clone_n<BaseType>(source.begin(), source.size(),
+                      std::back_inserter(copies));
+
+    REQUIRE(copies.size() == source.size());
+    REQUIRE(DerivedType::object_count == 16);
+    for (int i = 0; i < 8; ++i) {
+      REQUIRE(copies[i]->value() == i);
+      REQUIRE(copies[i].operator->() != source[i].operator->());
+    }
+
+    // The clones were placement-constructed back-to-back in a single slab.
+    for (int i = 1; i < 8; ++i) {
+      auto distance = reinterpret_cast<const char*>(copies[i].operator->()) -
+                      reinterpret_cast<const char*>(copies[0].operator->());
+      REQUIRE(distance > 0);
+      REQUIRE(distance < 8 * 256);
+    }
+
+    // Destroying some clones leaves the remainder valid.
+    copies.resize(3);
+    REQUIRE(copies[2]->value() == 2);
+
+    // Clones of arena-resident clones are ordinary deep copies.
+    polymorphic_value<BaseType> recloned(copies[0]);
+    REQUIRE(recloned->value() == 0);
+    REQUIRE(recloned.operator->() != copies[0].operator->());
+  }
+  REQUIRE(DerivedType::object_count == 0);
+}
+
+TEST_CASE("clone_n handles empty values and non-arena sources",
+          "[polymorphic_value.clone_n]") {
+  std::vector<polymorphic_value<BaseType>> source;
+  source.push_back(make_polymorphic_value<BaseType, DerivedType>(1));
+  source.push_back(polymorphic_value<BaseType>());
+  source.push_back(polymorphic_value<BaseType>(new DerivedType(3)));
+
+  std::vector<polymorphic_value<BaseType>> copies;
+  clone_n<BaseType>(source.begin(), source.size(), std::back_inserter(copies));
+
+  REQUIRE(copies.size() == 3);
+  REQUIRE(copies[0]->value() == 1);
+  REQUIRE_FALSE(bool(copies[1]));
+  REQUIRE(copies[2]->value() == 3);
+  REQUIRE(copies[2].operator->() != source[2].operator->());
+}
+
 TEST_CASE("make_polymorphic_value with single template argument",
           "[polymorphic_value.make_polymorphic_value.single]") {
   auto pv = make_polymorphic_value<DerivedType>(7);
@@ -573,6 +684,70 @@ TEST_CASE("Derived types", "[polymorphic_value.derived_types]") {
   }
 }
 
+namespace {
+struct ChainBase {
+  virtual ~ChainBase() = default;
+  int base_ = 1;
+};
+struct ChainMiddle : ChainBase {
+  int middle_ = 2;
+};
+struct ChainLeaf : ChainMiddle {
+  int leaf_ = 3;
+};
+}  // namespace
+
+TEST_CASE("Conversions over multiple levels remain correct",
+          "[polymorphic_value.conversion_flattening]") {
+  GIVEN("A value converted up through a three-level hierarchy") {
+    polymorphic_value<ChainLeaf> leaf(std::in_place_type<ChainLeaf>);
+    leaf->leaf_ = 7;
+
+    polymorphic_value<ChainMiddle> middle(std::move(leaf));
+    polymorphic_value<ChainBase> base(std::move(middle));
+
+    THEN("the converted value dereferences correctly") {
+      REQUIRE(base->base_ == 1);
+    }
+
+    THEN("copies of the converted value are deep and correct") {
+      polymorphic_value<ChainBase> copy(base);
+      REQUIRE(copy.operator->() != base.operator->());
+      REQUIRE(copy->base_ == 1);
+
+      copy->base_ = 99;
+      REQUIRE(base->base_ == 1);
+    }
+
+    THEN("copies of copies keep working") {
+      polymorphic_value<ChainBase> copy(base);
+      polymorphic_value<ChainBase> copy2(copy);
+      REQUIRE(copy2->base_ == 1);
+    }
+  }
+
+  GIVEN("A value converted via const lvalue conversions") {
+    polymorphic_value<ChainLeaf> leaf(std::in_place_type<ChainLeaf>);
+    polymorphic_value<ChainMiddle> middle(leaf);
+    polymorphic_value<ChainBase> base(middle);
+
+    THEN("source and converted values are independent") {
+      REQUIRE(bool(leaf));
+      REQUIRE(bool(middle));
+      base->base_ = 42;
+      REQUIRE(leaf->base_ == 1);
+      REQUIRE(middle->base_ == 1);
+    }
+  }
+
+  GIVEN("An empty value converted to a base type") {
+    polymorphic_value<ChainLeaf> empty;
+    polymorphic_value<ChainBase> base(std::move(empty));
+
+    THEN("the result is empty") { REQUIRE_FALSE(bool(base)); }
+  }
+}
+
 struct Base {
   int v_ = 42;
   virtual ~Base() = default;
@@ -673,15 +848,16 @@ TEST_CASE("Exception safety: throw in copy constructor",
     }
 
     THEN(
-        "When copying to another polymorphic_value, after an exception, the "
-        "destination is not changed") {
+        "When copying onto a non-empty polymorphic_value of the same type, "
+        "the payload is copy-assigned in place and no copy is made") {
       const int v2 = 5;
       polymorphic_value<ThrowsOnCopy> another(std::in_place_type<ThrowsOnCopy>,
                                               v2);
       Tracked::reset_counts();
-      REQUIRE_THROWS_AS(another = cptr, std::runtime_error);
-      REQUIRE(another->value_ == v2);
-      REQUIRE(Tracked::ctor_count_ - Tracked::dtor_count_ == 0);
+      another = cptr;
+      REQUIRE(another->value_ == v);
+      REQUIRE(Tracked::ctor_count_ == 0);
+      REQUIRE(Tracked::assignment_count_ == 1);
     }
   }
 }
@@ -759,6 +935,16 @@ TEST_CASE("polymorphic_value dynamic and static type mismatch",
                   bad_polymorphic_value_construction);
 }
 
+TEST_CASE("unique_ptr adoption with dynamic and static type mismatch",
+          "[polymorphic_value.construction]") {
+  CHECK_THROWS_AS(
+      [] {
+        std::unique_ptr<DerivedType> p = std::make_unique<DeeplyDerivedType>();
+        return polymorphic_value<BaseType>(std::move(p));
+      }(),
+      bad_polymorphic_value_construction);
+}
+
 struct fake_copy {
   template <class T>
   DerivedType* operator()(const T& b) const {
@@ -877,9 +1063,759 @@ TEST_CASE("Allocator used to construct with allocate_polymorphic_value") {
     unsigned const value = 99;
     polymorphic_value<DerivedType> p = allocate_polymorphic_value<DerivedType>(
         std::allocator_arg_t{}, alloc, value);
+    CHECK(allocs == 1);
+    CHECK(deallocs == 0);
+  }
+  CHECK(allocs == 1);
+  CHECK(deallocs == 1);
+}
+
+#ifdef ISOCPP_P0201_POLYMORPHIC_VALUE_HAS_MEMORY_RESOURCE
+namespace {
+class counting_memory_resource : public std::pmr::memory_resource {
+ public:
+  unsigned allocs = 0;
+  unsigned deallocs = 0;
+
+ private:
+  void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+    ++allocs;
+    return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+  }
+
+  void do_deallocate(void* p, std::size_t bytes,
+                     std::size_t alignment) override {
+    ++deallocs;
+    std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+  }
+
+  bool do_is_equal(
+      const std::pmr::memory_resource& other) const noexcept override {
+    return this == &other;
+  }
+};
+}  // namespace
+
+TEST_CASE("pmr::make_polymorphic_value routes allocation through the resource",
+          "[polymorphic_value.pmr]") {
+  counting_memory_resource resource;
+
+  {
+    pmr::polymorphic_value<BaseType> p =
+        pmr::make_polymorphic_value<BaseType, DerivedType>(&resource, 7);
+    CHECK(p->value() == 7);
+    CHECK(resource.allocs == 1);
+    CHECK(resource.deallocs == 0);
+  }
+  CHECK(resource.allocs == 1);
+  CHECK(resource.deallocs == 1);
+}
+
+TEST_CASE("pmr resource survives copies", "[polymorphic_value.pmr]") {
+  counting_memory_resource resource;
+
+  {
+    pmr::polymorphic_value<BaseType> p =
+        pmr::make_polymorphic_value<BaseType, DerivedType>(&resource, 7);
+
+    pmr::polymorphic_value<BaseType> p2(p);
+    CHECK(p2->value() == 7);
+    CHECK(resource.allocs == 2);
+
+    pmr::polymorphic_value<BaseType> p3(p2);
+    CHECK(resource.allocs == 3);
+    CHECK(resource.deallocs == 0);
+  }
+  CHECK(resource.allocs == 3);
+  CHECK(resource.deallocs == 3);
+}
+#endif  // ISOCPP_P0201_POLYMORPHIC_VALUE_HAS_MEMORY_RESOURCE
+
+TEST_CASE("Copying allocate_polymorphic_value-constructed object allocates once") {
+  unsigned allocs = 0;
+  unsigned deallocs = 0;
+
+  tracking_allocator<DerivedType> alloc(&allocs, &deallocs);
+
+  {
+    unsigned const value = 99;
+    polymorphic_value<DerivedType> p = allocate_polymorphic_value<DerivedType>(
+        std::allocator_arg_t{}, alloc, value);
+    CHECK(allocs == 1);
+
+    polymorphic_value<DerivedType> p2(p);
     CHECK(allocs == 2);
     CHECK(deallocs == 0);
+    CHECK(p2->value() == 99);
+    CHECK(p2.operator->() != p.operator->());
   }
   CHECK(allocs == 2);
   CHECK(deallocs == 2);
 }
+
+TEST_CASE("Trivial relocatability trait", "[polymorphic_value.relocation]") {
+  static_assert(is_trivially_relocatable_v<polymorphic_value<BaseType>>, "");
+  static_assert(is_trivially_relocatable_v<int>, "");
+  static_assert(!is_trivially_relocatable_v<std::vector<int>>, "");
+  static_assert(std::is_same<polymorphic_value<BaseType>::IsRelocatable,
+                             std::true_type>::value,
+                "");
+}
+
+TEST_CASE("Relocation by memcpy", "[polymorphic_value.relocation]") {
+  using PV = polymorphic_value<BaseType>;
+  std::aligned_storage_t<sizeof(PV), alignof(PV)> from_storage;
+  std::aligned_storage_t<sizeof(PV), alignof(PV)> to_storage;
+
+  CHECK(DerivedType::object_count == 0);
+
+  PV* from = ::new (&from_storage) PV(
+      make_polymorphic_value<BaseType, DerivedType>(42));
+  std::memcpy(&to_storage, &from_storage, sizeof(PV));
+
+  // The source is abandoned, not destroyed: the relocated object is the same
+  // object, so running both destructors would be a double-free.
+  PV* to = reinterpret_cast<PV*>(&to_storage);
+  CHECK((*to)->value() == 42);
+  CHECK(DerivedType::object_count == 1);
+  (void)from;
+
+  to->~PV();
+  CHECK(DerivedType::object_count == 0);
+}
+
+namespace {
+struct OtherSameSizeDerived : BaseType {
+  int value_ = 0;
+
+  OtherSameSizeDerived(int v) : value_(v) {}
+
+  int value() const override { return value_; }
+
+  void set_value(int i) override { value_ = i; }
+};
+
+struct WideDerived : BaseType {
+  int value_ = 0;
+  double padding_[8] = {};
+
+  WideDerived(int v) : value_(v) {}
+
+  int value() const override { return value_; }
+
+  void set_value(int i) override { value_ = i; }
+};
+}  // namespace
+
+TEST_CASE("emplace reuses same-footprint control-block storage",
+          "[polymorphic_value.emplace]") {
+  CHECK(DerivedType::object_count == 0);
+  {
+    polymorphic_value<BaseType> p =
+        make_polymorphic_value<BaseType, DerivedType>(1);
+    const BaseType* before = p.operator->();
+
+    p.emplace<OtherSameSizeDerived>(2);
+
+    CHECK(DerivedType::object_count == 0);
+    CHECK(p->value() == 2);
+    CHECK(static_cast<const void*>(p.operator->()) ==
+          static_cast<const void*>(before));
+
+    p.emplace<DerivedType>(3);
+    CHECK(DerivedType::object_count == 1);
+    CHECK(p->value() == 3);
+    CHECK(static_cast<const void*>(p.operator->()) ==
+          static_cast<const void*>(before));
+  }
+  CHECK(DerivedType::object_count == 0);
+}
+
+TEST_CASE("emplace falls back to reallocation when the footprint grows",
+          "[polymorphic_value.emplace]") {
+  polymorphic_value<BaseType> p =
+      make_polymorphic_value<BaseType, DerivedType>(1);
+
+  p.emplace<WideDerived>(2);
+  CHECK(p->value() == 2);
+  CHECK(DerivedType::object_count == 0);
+
+  p.emplace<DerivedType>(3);
+  CHECK(p->value() == 3);
+  CHECK(DerivedType::object_count == 1);
+}
+
+TEST_CASE("emplace on an empty or indirect value",
+          "[polymorphic_value.emplace]") {
+  polymorphic_value<BaseType> p;
+  p.emplace<DerivedType>(4);
+  REQUIRE(bool(p));
+  CHECK(p->value() == 4);
+
+  // A value adopting a raw pointer has no direct block to reuse.
+  polymorphic_value<BaseType> q(new DerivedType(5));
+  q.emplace<DerivedType>(6);
+  CHECK(q->value() == 6);
+  CHECK(DerivedType::object_count == 2);
+}
+
+namespace {
+struct PodPayload {
+  int a = 0;
+  double b = 0.0;
+};
+
+struct NonTrivialPayload {
+  int a = 0;
+
+  NonTrivialPayload() = default;
+
+  NonTrivialPayload(const NonTrivialPayload& p) : a(p.a) {}
+};
+}  // namespace
+
+TEST_CASE("is_trivially_clonable trait", "[polymorphic_value.trivial_clone]") {
+  static_assert(is_trivially_clonable_v<PodPayload>, "");
+  static_assert(!is_trivially_clonable_v<NonTrivialPayload>, "");
+  static_assert(!is_trivially_clonable_v<DerivedType>, "");
+}
+
+TEST_CASE("Trivially copyable payloads clone by byte copy",
+          "[polymorphic_value.trivial_clone]") {
+  polymorphic_value<PodPayload> p =
+      make_polymorphic_value<PodPayload>(PodPayload{7, 2.5});
+
+  polymorphic_value<PodPayload> p2(p);
+
+  REQUIRE(bool(p2));
+  CHECK(p2->a == 7);
+  CHECK(p2->b == 2.5);
+  CHECK(p2.operator->() != p.operator->());
+
+  p2->a = 8;
+  CHECK(p->a == 7);
+
+  polymorphic_value<PodPayload> p3;
+  p3 = p2;
+  CHECK(p3->a == 8);
+}
+
+TEST_CASE("Conversion keeps using the original allocator",
+          "[polymorphic_value.allocator]") {
+  unsigned allocs = 0;
+  unsigned deallocs = 0;
+
+  tracking_allocator<DerivedType> alloc(&allocs, &deallocs);
+
+  {
+    polymorphic_value<DerivedType> p = allocate_polymorphic_value<DerivedType>(
+        std::allocator_arg_t{}, alloc, 1);
+    CHECK(allocs == 1);
+
+    // The conversion wrapper is allocated from the source's allocator.
+    polymorphic_value<BaseType> b(std::move(p));
+    CHECK(allocs == 2);
+    CHECK(b->value() == 1);
+
+    // So are its clones: one block plus one wrapper per copy.
+    polymorphic_value<BaseType> b2(b);
+    CHECK(allocs == 4);
+    CHECK(deallocs == 0);
+    CHECK(b2->value() == 1);
+  }
+  CHECK(allocs == 4);
+  CHECK(deallocs == 4);
+}
+
+namespace {
+struct FinalDerived final : BaseType {
+  int value_ = 0;
+
+  FinalDerived(int v) : value_(v) {}
+
+  int value() const override { return value_; }
+
+  void set_value(int i) override { value_ = i; }
+};
+}  // namespace
+
+TEST_CASE("Final payload types", "[polymorphic_value.final]") {
+  polymorphic_value<BaseType> p =
+      make_polymorphic_value<BaseType, FinalDerived>(1);
+
+  polymorphic_value<BaseType> p2(p);
+  CHECK(p2->value() == 1);
+  CHECK(p2.operator->() != p.operator->());
+
+  p.emplace<FinalDerived>(2);
+  CHECK(p->value() == 2);
+}
+
+namespace {
+struct NonAssignableDerived : BaseType {
+  const int value_;
+
+  NonAssignableDerived(int v) : value_(v) {}
+
+  int value() const override { return value_; }
+
+  void set_value(int) override {}
+};
+}  // namespace
+
+TEST_CASE("Copy assignment reuses the destination block for matching types",
+          "[polymorphic_value.assignment]") {
+  polymorphic_value<BaseType> p = make_polymorphic_value<BaseType, DerivedType>(1);
+  polymorphic_value<BaseType> q = make_polymorphic_value<BaseType, DerivedType>(2);
+  const BaseType* stored = q.operator->();
+  const size_t count = DerivedType::object_count;
+
+  q = p;
+
+  CHECK(q->value() == 1);
+  CHECK(q.operator->() == stored);
+  CHECK(DerivedType::object_count == count);
+
+  p->set_value(3);
+  CHECK(q->value() == 1);
+}
+
+TEST_CASE("Copy assignment falls back to clone when block types differ",
+          "[polymorphic_value.assignment]") {
+  polymorphic_value<BaseType> p = make_polymorphic_value<BaseType, DerivedType>(1);
+  polymorphic_value<BaseType> q =
+      make_polymorphic_value<BaseType, OtherSameSizeDerived>(2);
+
+  q = p;
+  CHECK(q->value() == 1);
+
+  // Non-assignable payloads are cloned even when the types match.
+  polymorphic_value<BaseType> r =
+      make_polymorphic_value<BaseType, NonAssignableDerived>(3);
+  polymorphic_value<BaseType> s =
+      make_polymorphic_value<BaseType, NonAssignableDerived>(4);
+  s = r;
+  CHECK(s->value() == 3);
+  CHECK(s.operator->() != r.operator->());
+}
+
+namespace {
+struct MoreDerivedType : DerivedType {
+  MoreDerivedType(int v) : DerivedType(v) {}
+};
+}  // namespace
+
+TEST_CASE("try_make_polymorphic_value", "[polymorphic_value.try_factories]") {
+  auto p = try_make_polymorphic_value<BaseType, DerivedType>(7);
+
+  REQUIRE(bool(p));
+  CHECK(p->value() == 7);
+}
+
+TEST_CASE("try_adopt", "[polymorphic_value.try_factories]") {
+  GIVEN("A pointer whose dynamic and static types match") {
+    auto p = try_adopt<BaseType>(new DerivedType(7));
+
+    REQUIRE(bool(p));
+    CHECK(p->value() == 7);
+  }
+
+  GIVEN("A null pointer") {
+    DerivedType* null_derived_ptr = nullptr;
+    auto p = try_adopt<BaseType>(null_derived_ptr);
+
+    CHECK(!bool(p));
+  }
+
+  GIVEN("A pointer whose dynamic type is more derived than its static type") {
+    auto u = std::make_unique<MoreDerivedType>(7);
+    DerivedType* raw = u.get();
+
+    WHEN("try_adopt is called with the default copier and deleter") {
+      polymorphic_value<BaseType> p = try_adopt<BaseType>(raw);
+
+      THEN("the result is empty and the caller keeps ownership") {
+        CHECK(!bool(p));
+        CHECK(u->value() == 7);
+      }
+    }
+  }
+}
+
+TEST_CASE("Registered type tags drive the mismatch check",
+          "[polymorphic_value.type_tags]") {
+  const DerivedType exemplar(0);
+  register_type_tag(exemplar);
+
+  GIVEN("A pointer whose dynamic type matches the registered tag") {
+    polymorphic_value<BaseType> p(new DerivedType(7));
+    REQUIRE(p->value() == 7);
+  }
+
+  GIVEN("A pointer whose dynamic type does not match the registered tag") {
+    auto u = std::make_unique<MoreDerivedType>(7);
+    DerivedType* raw = u.get();
+
+    THEN("the pointer constructor throws") {
+      REQUIRE_THROWS_AS(polymorphic_value<BaseType>(raw),
+                        bad_polymorphic_value_construction);
+    }
+
+    THEN("try_adopt returns an empty value") {
+      CHECK(!bool(try_adopt<BaseType>(raw)));
+    }
+  }
+}
+
+TEST_CASE("visit dispatches on the stored payload type",
+          "[polymorphic_value.visit]") {
+  std::vector<polymorphic_value<BaseType>> events;
+  events.push_back(make_polymorphic_value<BaseType, DerivedType>(1));
+  events.push_back(make_polymorphic_value<BaseType, OtherSameSizeDerived>(2));
+  events.push_back(make_polymorphic_value<BaseType, DerivedType>(3));
+
+  int derived_total = 0;
+  int other_total = 0;
+  int fallback_count = 0;
+  for (const auto& event : events) {
+    visit<DerivedType, OtherSameSizeDerived>(
+        event, [&](const auto& e) {
+          using E = std::decay_t<decltype(e)>;
+          if (std::is_same<E, DerivedType>::value) {
+            derived_total += e.value();
+          } else if (std::is_same<E, OtherSameSizeDerived>::value) {
+            other_total += e.value();
+          } else {
+            ++fallback_count;
+          }
+        });
+  }
+
+  CHECK(derived_total == 4);
+  CHECK(other_total == 2);
+  CHECK(fallback_count == 0);
+}
+
+TEST_CASE("visit returns the visitor's result and can mutate",
+          "[polymorphic_value.visit]") {
+  auto p = make_polymorphic_value<BaseType, DerivedType>(7);
+
+  const int doubled = visit<DerivedType>(
+      p, [](const auto& e) { return 2 * e.value(); });
+  CHECK(doubled == 14);
+
+  visit<DerivedType>(p, [](auto& e) { e.set_value(9); });
+  CHECK(p->value() == 9);
+}
+
+TEST_CASE("visit falls back to the base reference",
+          "[polymorphic_value.visit]") {
+  GIVEN("A payload type missing from the candidate list") {
+    auto p = make_polymorphic_value<BaseType, WideDerived>(5);
+
+    const bool matched = visit<DerivedType>(
+        p, [](const auto& e) {
+          return !std::is_same<std::decay_t<decltype(e)>, BaseType>::value;
+        });
+    CHECK(!matched);
+    CHECK(visit<DerivedType>(p, [](const auto& e) { return e.value(); }) == 5);
+  }
+
+  GIVEN("A value adopted through a pointer") {
+    polymorphic_value<BaseType> p(new DerivedType(5));
+
+    const bool matched = visit<DerivedType>(
+        p, [](const auto& e) {
+          return !std::is_same<std::decay_t<decltype(e)>, BaseType>::value;
+        });
+    CHECK(!matched);
+  }
+}
+
+TEST_CASE("visit recognizes payloads cloned through a bulk arena",
+          "[polymorphic_value.visit]") {
+  std::vector<polymorphic_value<BaseType>> source;
+  source.push_back(make_polymorphic_value<BaseType, DerivedType>(3));
+  std::vector<polymorphic_value<BaseType>> copies;
+  clone_n<BaseType>(source.begin(), source.size(), std::back_inserter(copies));
+
+  const bool matched = visit<DerivedType>(
+      copies[0], [](const auto& e) {
+        return std::is_same<std::decay_t<decltype(e)>, DerivedType>::value;
+      });
+  CHECK(matched);
+}
+
+namespace {
+struct alignas(64) SimdDerived : BaseType {
+  int value_ = 0;
+
+  SimdDerived(int v) : value_(v) {}
+
+  int value() const override { return value_; }
+
+  void set_value(int i) override { value_ = i; }
+};
+
+bool aligned_to_64(const void* p) {
+  return reinterpret_cast<std::uintptr_t>(p) % 64 == 0;
+}
+}  // namespace
+
+TEST_CASE("Over-aligned payloads are aligned on every creation path",
+          "[polymorphic_value.alignment]") {
+  GIVEN("An in-place constructed over-aligned payload") {
+    polymorphic_value<BaseType> p(std::in_place_type<SimdDerived>, 1);
+    REQUIRE(aligned_to_64(p.operator->()));
+
+    THEN("copies are aligned") {
+      polymorphic_value<BaseType> q(p);
+      REQUIRE(aligned_to_64(q.operator->()));
+      REQUIRE(q->value() == 1);
+    }
+
+    THEN("emplace keeps the replacement aligned") {
+      p.emplace<SimdDerived>(2);
+      REQUIRE(aligned_to_64(p.operator->()));
+      REQUIRE(p->value() == 2);
+    }
+  }
+
+  GIVEN("An allocator-constructed over-aligned payload") {
+    std::allocator<SimdDerived> alloc;
+    auto p = allocate_polymorphic_value<BaseType, SimdDerived>(
+        std::allocator_arg, alloc, 3);
+    REQUIRE(aligned_to_64(p.operator->()));
+
+    polymorphic_value<BaseType> q(p);
+    REQUIRE(aligned_to_64(q.operator->()));
+  }
+
+  GIVEN("A converting construction from an over-aligned payload") {
+    polymorphic_value<SimdDerived> p(std::in_place_type<SimdDerived>, 4);
+    polymorphic_value<BaseType> q(std::move(p));
+    REQUIRE(aligned_to_64(q.operator->()));
+    REQUIRE(q->value() == 4);
+  }
+}
+
+TEST_CASE("Converting assignment from a value", "[polymorphic_value.assignment]") {
+  GIVEN("A non-empty polymorphic_value") {
+    polymorphic_value<BaseType> p(std::in_place_type<DerivedType>, 1);
+
+    WHEN("a same-footprint value is assigned") {
+      const BaseType* stored = p.operator->();
+      p = OtherSameSizeDerived(2);
+
+      THEN("the storage is reused") {
+        CHECK(p->value() == 2);
+        CHECK(p.operator->() == stored);
+      }
+    }
+
+    WHEN("a wider value is assigned") {
+      p = WideDerived(3);
+      CHECK(p->value() == 3);
+    }
+
+    WHEN("an lvalue is assigned") {
+      DerivedType d(4);
+      p = d;
+      CHECK(p->value() == 4);
+      CHECK(d.value() == 4);
+    }
+  }
+
+  GIVEN("An empty polymorphic_value") {
+    polymorphic_value<BaseType> p;
+    p = DerivedType(5);
+
+    REQUIRE(bool(p));
+    CHECK(p->value() == 5);
+  }
+}
+
+TEST_CASE("Copy-converting constructor clones without a temporary",
+          "[polymorphic_value.constructors]") {
+  polymorphic_value<DerivedType> p(std::in_place_type<DerivedType>, 7);
+  const size_t count = DerivedType::object_count;
+
+  polymorphic_value<BaseType> q(p);
+
+  THEN("exactly one copy of the payload is made") {
+    CHECK(DerivedType::object_count == count + 1);
+    CHECK(q->value() == 7);
+  }
+
+  THEN("source and converted value are independent") {
+    q->set_value(8);
+    CHECK(p->value() == 7);
+  }
+
+  THEN("the converted value clones and destroys cleanly") {
+    {
+      polymorphic_value<BaseType> r(q);
+      CHECK(r->value() == 7);
+      CHECK(r.operator->() != q.operator->());
+    }
+    CHECK(DerivedType::object_count == count + 1);
+  }
+}
+
+TEST_CASE("Move-converting from a copy-converted value takes over its block",
+          "[polymorphic_value.constructors]") {
+  polymorphic_value<MoreDerivedType> p(std::in_place_type<MoreDerivedType>, 7);
+  polymorphic_value<DerivedType> q(p);
+  const BaseType* stored = q.operator->();
+
+  polymorphic_value<BaseType> r(std::move(q));
+
+  REQUIRE(bool(r));
+  CHECK(r.operator->() == stored);
+  CHECK(r->value() == 7);
+}
+
+TEST_CASE("Unchecked observers", "[polymorphic_value.observers]") {
+  polymorphic_value<BaseType> p(std::in_place_type<DerivedType>, 7);
+  const polymorphic_value<BaseType>& cp = p;
+
+  CHECK(p.unchecked_ptr() == p.operator->());
+  CHECK(cp.unchecked_ptr() == cp.operator->());
+  CHECK(p.unchecked().value() == 7);
+  CHECK(cp.unchecked().value() == 7);
+
+  p.unchecked().set_value(8);
+  CHECK(cp.unchecked().value() == 8);
+}
+
+namespace {
+struct AllocatorAwareDerived : BaseType {
+  using allocator_type = tracking_allocator<unsigned char>;
+
+  int value_ = 0;
+  bool constructed_with_allocator = false;
+
+  AllocatorAwareDerived(int v) : value_(v) {}
+
+  AllocatorAwareDerived(int v, const allocator_type&)
+      : value_(v), constructed_with_allocator(true) {}
+
+  AllocatorAwareDerived(const AllocatorAwareDerived& d, const allocator_type&)
+      : value_(d.value_), constructed_with_allocator(true) {}
+
+  int value() const override { return value_; }
+
+  void set_value(int i) override { value_ = i; }
+};
+}  // namespace
+
+TEST_CASE("Allocator-aware payloads are built with the allocator",
+          "[polymorphic_value.constructors]") {
+  unsigned allocs = 0;
+  unsigned deallocs = 0;
+
+  tracking_allocator<AllocatorAwareDerived> alloc(&allocs, &deallocs);
+
+  polymorphic_value<AllocatorAwareDerived> p =
+      allocate_polymorphic_value<AllocatorAwareDerived>(std::allocator_arg_t{},
+                                                        alloc, 42);
+  REQUIRE(bool(p));
+  CHECK(p->value() == 42);
+  CHECK(p->constructed_with_allocator);
+
+  // Clones pass it again.
+  polymorphic_value<AllocatorAwareDerived> q(p);
+  CHECK(q->constructed_with_allocator);
+  CHECK(q->value() == 42);
+}
+
+TEST_CASE("emplace on an allocated value keeps its allocator",
+          "[polymorphic_value.modifiers]") {
+  unsigned allocs = 0;
+  unsigned deallocs = 0;
+
+  tracking_allocator<DerivedType> alloc(&allocs, &deallocs);
+
+  {
+    polymorphic_value<BaseType> p =
+        allocate_polymorphic_value<BaseType, DerivedType>(std::allocator_arg_t{},
+                                                          alloc, 1);
+    REQUIRE(allocs == 1);
+
+    // The replacement block and its storage come from the tracked allocator,
+    // not the global heap.
+    p.emplace<DerivedType>(2);
+    CHECK(p->value() == 2);
+    CHECK(allocs == 2);
+    CHECK(deallocs == 1);
+
+    // So do clones of the replacement...
+    polymorphic_value<BaseType> q(p);
+    CHECK(q->value() == 2);
+    CHECK(allocs == 3);
+
+    // ...and later replacements.
+    q.emplace<DerivedType>(3);
+    CHECK(q->value() == 3);
+    CHECK(allocs == 4);
+    CHECK(deallocs == 2);
+  }
+  CHECK(allocs == deallocs);
+  CHECK(DerivedType::object_count == 0);
+}
+
+TEST_CASE("visit dispatches through converting constructions",
+          "[polymorphic_value.visit]") {
+  GIVEN("A copy-converted value") {
+    polymorphic_value<DerivedType> d(std::in_place_type<DerivedType>, 5);
+    polymorphic_value<BaseType> b(d);
+
+    THEN("visit still sees the leaf payload type") {
+      const bool matched = visit<DerivedType>(b, [](const auto& e) {
+        return std::is_same<std::decay_t<decltype(e)>, DerivedType>::value;
+      });
+      CHECK(matched);
+    }
+  }
+
+  GIVEN("A move-converted value") {
+    polymorphic_value<DerivedType> d(std::in_place_type<DerivedType>, 6);
+    polymorphic_value<BaseType> b(std::move(d));
+
+    THEN("visit still sees the leaf payload type") {
+      const bool matched = visit<DerivedType>(b, [](const auto& e) {
+        return std::is_same<std::decay_t<decltype(e)>, DerivedType>::value;
+      });
+      CHECK(matched);
+      CHECK(visit<DerivedType>(b, [](const auto& e) { return e.value(); }) ==
+            6);
+    }
+  }
+}
+
+TEST_CASE("Assigning a value its own object is safe",
+          "[polymorphic_value.assignment]") {
+  GIVEN("A value assigned its own stored object") {
+    polymorphic_value<DerivedType> p(std::in_place_type<DerivedType>, 7);
+
+    p = *p;
+
+    THEN("The value is unchanged") {
+      REQUIRE(bool(p));
+      CHECK(p->value() == 7);
+    }
+  }
+
+  GIVEN("emplace called with a reference to the stored object") {
+    polymorphic_value<BaseType> p(std::in_place_type<DerivedType>, 8);
+
+    p.emplace<DerivedType>(
+        static_cast<const DerivedType&>(*p.operator->()));
+
+    THEN("The replacement carries the old object's state") {
+      REQUIRE(bool(p));
+      CHECK(p->value() == 8);
+    }
+  }
+  CHECK(DerivedType::object_count == 0);
+}
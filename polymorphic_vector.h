@@ -0,0 +1,390 @@
+/* Copyright (c) 2016 The Polymorphic Value Authors. All Rights Reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+==============================================================================*/
+
+#ifndef ISOCPP_P0201_POLYMORPHIC_VECTOR_H_INCLUDED
+#define ISOCPP_P0201_POLYMORPHIC_VECTOR_H_INCLUDED
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace isocpp_p0201 {
+
+namespace detail {
+
+////////////////////////////////////////////////////////////////////////////
+// Implementation detail classes
+////////////////////////////////////////////////////////////////////////////
+
+// Per-type thunk table for arena-resident objects: the clone/destroy
+// operations a control block would encode, but targeting caller-provided
+// storage instead of a fresh allocation.
+template <class T>
+struct arena_vtable {
+  void (*copy_to)(const void* src, void* dst);
+  void (*relocate_to)(void* src, void* dst);
+  void (*destroy)(void* p) noexcept;
+  T* (*ptr)(void* p) noexcept;
+  std::size_t size;
+  std::size_t align;
+};
+
+template <class T, class U>
+struct arena_ops {
+  static void copy_to(const void* src, void* dst) {
+    ::new (dst) U(*static_cast<const U*>(src));
+  }
+
+  static void relocate_to(void* src, void* dst) {
+    ::new (dst) U(std::move_if_noexcept(*static_cast<U*>(src)));
+  }
+
+  static void destroy(void* p) noexcept { static_cast<U*>(p)->~U(); }
+
+  static T* ptr(void* p) noexcept { return static_cast<U*>(p); }
+
+  static constexpr arena_vtable<T> vtable = {&copy_to, &relocate_to, &destroy,
+                                             &ptr, sizeof(U), alignof(U)};
+};
+
+template <class T, class U>
+constexpr arena_vtable<T> arena_ops<T, U>::vtable;
+
+inline std::size_t align_up(std::size_t offset, std::size_t align) {
+  return (offset + align - 1) & ~(align - 1);
+}
+
+}  // end namespace detail
+
+////////////////////////////////////////////////////////////////////////////////
+// `polymorphic_vector` class definition
+////////////////////////////////////////////////////////////////////////////////
+
+// A sequence of polymorphic objects stored back-to-back in a single growable
+// arena. An index of offsets plus per-type thunk tables replaces the
+// per-element control blocks, so iteration is a linear walk over contiguous
+// storage and the container needs one allocation for all stored objects
+// rather than one per element.
+template <class T>
+class polymorphic_vector {
+  static_assert(!std::is_union<T>::value, "");
+  static_assert(std::is_class<T>::value, "");
+
+  struct entry {
+    std::size_t offset;
+    const detail::arena_vtable<T>* ops;
+  };
+
+  unsigned char* buffer_ = nullptr;
+  std::size_t capacity_ = 0;
+  std::size_t bytes_ = 0;
+  std::vector<entry> index_;
+
+  void* storage(const entry& e) const { return buffer_ + e.offset; }
+
+  // Relocates every element into `new_buffer` (same offsets) and destroys the
+  // originals. Elements whose move constructor may throw are copied; on
+  // failure the already-relocated prefix is destroyed and the old buffer is
+  // left intact.
+  void relocate_all(unsigned char* new_buffer) {
+    std::size_t done = 0;
+    try {
+      for (; done != index_.size(); ++done) {
+        const entry& e = index_[done];
+        e.ops->relocate_to(storage(e), new_buffer + e.offset);
+      }
+    } catch (...) {
+      for (std::size_t i = 0; i != done; ++i) {
+        const entry& e = index_[i];
+        e.ops->destroy(new_buffer + e.offset);
+      }
+      throw;
+    }
+    for (const entry& e : index_) {
+      e.ops->destroy(storage(e));
+    }
+  }
+
+  void grow(std::size_t required_bytes) {
+    std::size_t new_capacity = capacity_ ? capacity_ * 2 : 256;
+    if (new_capacity < required_bytes) {
+      new_capacity = required_bytes;
+    }
+    auto* new_buffer = static_cast<unsigned char*>(::operator new(new_capacity));
+    try {
+      relocate_all(new_buffer);
+    } catch (...) {
+      ::operator delete(new_buffer);
+      throw;
+    }
+    ::operator delete(buffer_);
+    buffer_ = new_buffer;
+    capacity_ = new_capacity;
+  }
+
+  void destroy_all() noexcept {
+    for (const entry& e : index_) {
+      e.ops->destroy(storage(e));
+    }
+    index_.clear();
+    bytes_ = 0;
+  }
+
+ public:
+  using value_type = T;
+  using size_type = std::size_t;
+
+  template <bool IsConst>
+  class basic_iterator {
+    using vector_type =
+        std::conditional_t<IsConst, const polymorphic_vector, polymorphic_vector>;
+    vector_type* v_ = nullptr;
+    std::size_t i_ = 0;
+
+    friend class polymorphic_vector;
+
+    basic_iterator(vector_type* v, std::size_t i) : v_(v), i_(i) {}
+
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = std::conditional_t<IsConst, const T*, T*>;
+    using reference = std::conditional_t<IsConst, const T&, T&>;
+
+    basic_iterator() = default;
+
+    reference operator*() const { return (*v_)[i_]; }
+
+    pointer operator->() const { return std::addressof((*v_)[i_]); }
+
+    basic_iterator& operator++() {
+      ++i_;
+      return *this;
+    }
+
+    basic_iterator operator++(int) {
+      basic_iterator tmp(*this);
+      ++i_;
+      return tmp;
+    }
+
+    friend bool operator==(const basic_iterator& a, const basic_iterator& b) {
+      return a.v_ == b.v_ && a.i_ == b.i_;
+    }
+
+    friend bool operator!=(const basic_iterator& a, const basic_iterator& b) {
+      return !(a == b);
+    }
+  };
+
+  using iterator = basic_iterator<false>;
+  using const_iterator = basic_iterator<true>;
+
+  //
+  // Destructor
+  //
+
+  ~polymorphic_vector() {
+    destroy_all();
+    ::operator delete(buffer_);
+  }
+
+  //
+  // Constructors
+  //
+
+  polymorphic_vector() = default;
+
+  //
+  // Copy-constructors
+  //
+
+  polymorphic_vector(const polymorphic_vector& other) {
+    if (other.bytes_ == 0) {
+      return;
+    }
+    buffer_ = static_cast<unsigned char*>(::operator new(other.bytes_));
+    capacity_ = other.bytes_;
+    index_.reserve(other.index_.size());
+    try {
+      for (const entry& e : other.index_) {
+        e.ops->copy_to(other.storage(e), buffer_ + e.offset);
+        index_.push_back(e);
+      }
+    } catch (...) {
+      destroy_all();
+      ::operator delete(buffer_);
+      buffer_ = nullptr;
+      capacity_ = 0;
+      throw;
+    }
+    bytes_ = other.bytes_;
+  }
+
+  //
+  // Move-constructors
+  //
+
+  polymorphic_vector(polymorphic_vector&& other) noexcept
+      : buffer_(other.buffer_),
+        capacity_(other.capacity_),
+        bytes_(other.bytes_),
+        index_(std::move(other.index_)) {
+    other.buffer_ = nullptr;
+    other.capacity_ = 0;
+    other.bytes_ = 0;
+    other.index_.clear();
+  }
+
+  //
+  // Assignment
+  //
+
+  polymorphic_vector& operator=(const polymorphic_vector& other) {
+    if (std::addressof(other) == this) {
+      return *this;
+    }
+    polymorphic_vector tmp(other);
+    swap(tmp);
+    return *this;
+  }
+
+  polymorphic_vector& operator=(polymorphic_vector&& other) noexcept {
+    if (std::addressof(other) == this) {
+      return *this;
+    }
+    destroy_all();
+    ::operator delete(buffer_);
+    buffer_ = other.buffer_;
+    capacity_ = other.capacity_;
+    bytes_ = other.bytes_;
+    index_ = std::move(other.index_);
+    other.buffer_ = nullptr;
+    other.capacity_ = 0;
+    other.bytes_ = 0;
+    other.index_.clear();
+    return *this;
+  }
+
+  //
+  // Modifiers
+  //
+
+  template <class U, class... Ts>
+  T& emplace_back(Ts&&... ts) {
+    static_assert(std::is_convertible<U*, T*>::value, "");
+    static_assert(alignof(U) <= alignof(std::max_align_t),
+                  "over-aligned types are not supported by the arena");
+
+    const std::size_t offset = detail::align_up(bytes_, alignof(U));
+    if (offset + sizeof(U) > capacity_) {
+      grow(offset + sizeof(U));
+    }
+    // Grow the index geometrically (as `grow` does for the byte arena), but
+    // always before constructing the object: with capacity secured, the
+    // `push_back` below cannot throw and the raw-constructed `U` is never
+    // orphaned.
+    if (index_.size() == index_.capacity()) {
+      index_.reserve(std::max<std::size_t>(4, 2 * index_.capacity()));
+    }
+    U* u = ::new (buffer_ + offset) U(std::forward<Ts>(ts)...);
+    index_.push_back({offset, &detail::arena_ops<T, U>::vtable});
+    bytes_ = offset + sizeof(U);
+    return *u;
+  }
+
+  template <class U>
+  T& push_back(const U& u) {
+    return emplace_back<U>(u);
+  }
+
+  template <class U, class = std::enable_if_t<!std::is_lvalue_reference<U>::value>>
+  T& push_back(U&& u) {
+    return emplace_back<std::decay_t<U>>(std::move(u));
+  }
+
+  void clear() noexcept { destroy_all(); }
+
+  // Pre-allocates arena storage for at least `bytes` of object data.
+  void reserve_bytes(std::size_t bytes) {
+    if (bytes > capacity_) {
+      grow(bytes);
+    }
+  }
+
+  void swap(polymorphic_vector& other) noexcept {
+    using std::swap;
+    swap(buffer_, other.buffer_);
+    swap(capacity_, other.capacity_);
+    swap(bytes_, other.bytes_);
+    swap(index_, other.index_);
+  }
+
+  //
+  // Observers
+  //
+
+  size_type size() const noexcept { return index_.size(); }
+
+  bool empty() const noexcept { return index_.empty(); }
+
+  // Bytes of object data currently stored in the arena.
+  size_type size_bytes() const noexcept { return bytes_; }
+
+  size_type capacity_bytes() const noexcept { return capacity_; }
+
+  T& operator[](size_type i) {
+    assert(i < size());
+    const entry& e = index_[i];
+    return *e.ops->ptr(storage(e));
+  }
+
+  const T& operator[](size_type i) const {
+    assert(i < size());
+    const entry& e = index_[i];
+    return *e.ops->ptr(storage(e));
+  }
+
+  iterator begin() { return iterator(this, 0); }
+  iterator end() { return iterator(this, size()); }
+  const_iterator begin() const { return const_iterator(this, 0); }
+  const_iterator end() const { return const_iterator(this, size()); }
+  const_iterator cbegin() const { return begin(); }
+  const_iterator cend() const { return end(); }
+};
+
+//
+// non-member swap
+//
+template <class T>
+void swap(polymorphic_vector<T>& t, polymorphic_vector<T>& u) noexcept {
+  t.swap(u);
+}
+
+}  // namespace isocpp_p0201
+
+#endif  // ISOCPP_P0201_POLYMORPHIC_VECTOR_H_INCLUDED
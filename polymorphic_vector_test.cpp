@@ -0,0 +1,227 @@
+/* Copyright (c) 2016 The Polymorphic Value Authors. All Rights Reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+==============================================================================*/
+
+#include "polymorphic_vector.h"
+
+#include <utility>
+
+#undef CATCH_CONFIG_WINDOWS_SEH
+#include "catch2/catch_test_macros.hpp"
+
+using namespace isocpp_p0201;
+
+namespace {
+struct VecBase {
+  virtual int value() const = 0;
+  virtual void set_value(int) = 0;
+  virtual ~VecBase() = default;
+};
+
+struct VecDerived : VecBase {
+  int value_ = 0;
+
+  VecDerived(int v) : value_(v) { ++object_count; }
+
+  VecDerived(const VecDerived& d) : value_(d.value_) { ++object_count; }
+
+  VecDerived(VecDerived&& d) noexcept : value_(d.value_) { ++object_count; }
+
+  ~VecDerived() { --object_count; }
+
+  int value() const override { return value_; }
+
+  void set_value(int i) override { value_ = i; }
+
+  static size_t object_count;
+};
+
+size_t VecDerived::object_count = 0;
+
+struct WideVecDerived : VecBase {
+  int value_ = 0;
+  double padding_[8] = {};
+
+  WideVecDerived(int v) : value_(v) {}
+
+  int value() const override { return value_; }
+
+  void set_value(int i) override { value_ = i; }
+};
+
+}  // namespace
+
+TEST_CASE("polymorphic_vector default constructor",
+          "[polymorphic_vector.constructors]") {
+  polymorphic_vector<VecBase> v;
+
+  REQUIRE(v.empty());
+  REQUIRE(v.size() == 0);
+  REQUIRE(v.size_bytes() == 0);
+}
+
+TEST_CASE("polymorphic_vector emplace_back and element access",
+          "[polymorphic_vector.modifiers]") {
+  polymorphic_vector<VecBase> v;
+
+  v.emplace_back<VecDerived>(1);
+  v.emplace_back<WideVecDerived>(2);
+  v.emplace_back<VecDerived>(3);
+
+  REQUIRE(v.size() == 3);
+  REQUIRE(v[0].value() == 1);
+  REQUIRE(v[1].value() == 2);
+  REQUIRE(v[2].value() == 3);
+
+  v[1].set_value(99);
+  REQUIRE(v[1].value() == 99);
+}
+
+TEST_CASE("polymorphic_vector stores elements contiguously",
+          "[polymorphic_vector.arena]") {
+  polymorphic_vector<VecBase> v;
+  v.reserve_bytes(1024);
+
+  v.emplace_back<VecDerived>(1);
+  v.emplace_back<VecDerived>(2);
+  v.emplace_back<VecDerived>(3);
+
+  const char* first = reinterpret_cast<const char*>(&v[0]);
+  const char* second = reinterpret_cast<const char*>(&v[1]);
+  const char* third = reinterpret_cast<const char*>(&v[2]);
+
+  REQUIRE(second > first);
+  REQUIRE(third > second);
+  REQUIRE(static_cast<size_t>(third - first) <= v.size_bytes());
+}
+
+TEST_CASE("polymorphic_vector growth preserves elements",
+          "[polymorphic_vector.arena]") {
+  polymorphic_vector<VecBase> v;
+
+  for (int i = 0; i < 100; ++i) {
+    v.emplace_back<VecDerived>(i);
+  }
+
+  REQUIRE(v.size() == 100);
+  for (int i = 0; i < 100; ++i) {
+    REQUIRE(v[static_cast<size_t>(i)].value() == i);
+  }
+}
+
+TEST_CASE("polymorphic_vector iteration", "[polymorphic_vector.iterators]") {
+  polymorphic_vector<VecBase> v;
+  v.emplace_back<VecDerived>(1);
+  v.emplace_back<WideVecDerived>(2);
+  v.emplace_back<VecDerived>(4);
+
+  int total = 0;
+  for (const VecBase& b : v) {
+    total += b.value();
+  }
+  REQUIRE(total == 7);
+
+  for (VecBase& b : v) {
+    b.set_value(b.value() * 2);
+  }
+  REQUIRE(v[2].value() == 8);
+}
+
+TEST_CASE("polymorphic_vector copy is deep", "[polymorphic_vector.copy]") {
+  REQUIRE(VecDerived::object_count == 0);
+  {
+    polymorphic_vector<VecBase> v;
+    v.emplace_back<VecDerived>(1);
+    v.emplace_back<VecDerived>(2);
+
+    polymorphic_vector<VecBase> w(v);
+
+    REQUIRE(VecDerived::object_count == 4);
+    REQUIRE(w.size() == 2);
+    REQUIRE(&w[0] != &v[0]);
+
+    w[0].set_value(99);
+    REQUIRE(v[0].value() == 1);
+
+    v = w;
+    REQUIRE(v[0].value() == 99);
+  }
+  REQUIRE(VecDerived::object_count == 0);
+}
+
+TEST_CASE("polymorphic_vector move transfers the arena",
+          "[polymorphic_vector.move]") {
+  polymorphic_vector<VecBase> v;
+  v.emplace_back<VecDerived>(1);
+  const VecBase* stored = &v[0];
+
+  polymorphic_vector<VecBase> w(std::move(v));
+
+  REQUIRE(v.empty());
+  REQUIRE(w.size() == 1);
+  REQUIRE(&w[0] == stored);
+}
+
+TEST_CASE("polymorphic_vector clear destroys elements",
+          "[polymorphic_vector.modifiers]") {
+  polymorphic_vector<VecBase> v;
+  v.emplace_back<VecDerived>(1);
+  v.emplace_back<VecDerived>(2);
+
+  REQUIRE(VecDerived::object_count == 2);
+
+  v.clear();
+
+  REQUIRE(v.empty());
+  REQUIRE(VecDerived::object_count == 0);
+}
+
+TEST_CASE("polymorphic_vector push_back", "[polymorphic_vector.modifiers]") {
+  polymorphic_vector<VecBase> v;
+
+  VecDerived d(7);
+  v.push_back(d);
+  v.push_back(VecDerived(8));
+
+  REQUIRE(v.size() == 2);
+  REQUIRE(v[0].value() == 7);
+  REQUIRE(v[1].value() == 8);
+}
+
+TEST_CASE("polymorphic_vector bulk insertion grows geometrically",
+          "[polymorphic_vector.arena]") {
+  // Large enough that linear (per-insert) index reallocation would be
+  // quadratic and show up as a multi-second hang; geometric growth keeps
+  // this in the milliseconds.
+  constexpr int n = 50000;
+
+  {
+    polymorphic_vector<VecBase> v;
+    for (int i = 0; i < n; ++i) {
+      v.emplace_back<VecDerived>(i);
+    }
+
+    REQUIRE(v.size() == static_cast<size_t>(n));
+    CHECK(VecDerived::object_count == static_cast<size_t>(n));
+    CHECK(v[0].value() == 0);
+    CHECK(v[n / 2].value() == n / 2);
+    CHECK(v[n - 1].value() == n - 1);
+  }
+  CHECK(VecDerived::object_count == 0);
+}
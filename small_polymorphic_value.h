@@ -0,0 +1,333 @@
+/* Copyright (c) 2016 The Polymorphic Value Authors. All Rights Reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+==============================================================================*/
+
+#ifndef ISOCPP_P0201_SMALL_POLYMORPHIC_VALUE_H_INCLUDED
+#define ISOCPP_P0201_SMALL_POLYMORPHIC_VALUE_H_INCLUDED
+
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "polymorphic_value.h"
+
+namespace isocpp_p0201 {
+
+namespace detail {
+
+////////////////////////////////////////////////////////////////////////////
+// Implementation detail classes
+////////////////////////////////////////////////////////////////////////////
+
+// Control block interface for `small_polymorphic_value`. Unlike
+// `control_block`, clone and move are directed at a destination buffer so that
+// buffer-resident control blocks can be copied and moved without allocation.
+template <class T>
+struct sbo_control_block {
+  virtual ~sbo_control_block() = default;
+
+  // Clones into `buffer` if the control block is buffer-resident, otherwise
+  // allocates. Returns the address of the new control block.
+  virtual sbo_control_block* clone(void* buffer) const = 0;
+
+  // Moves into `buffer` if the control block is buffer-resident, otherwise
+  // transfers ownership of `this`. Returns the address of the new control
+  // block; the caller must destroy the source if the address differs.
+  virtual sbo_control_block* move_to(void* buffer) noexcept = 0;
+
+  virtual T* ptr() = 0;
+
+  virtual void destroy() noexcept { delete this; }
+};
+
+// Stores `U` directly inside the buffer of a `small_polymorphic_value`.
+// Destruction runs the destructor in place and deallocates nothing.
+template <class T, class U>
+class buffer_control_block final : public sbo_control_block<T> {
+  static_assert(!std::is_reference<U>::value, "");
+  static_assert(std::is_nothrow_move_constructible<U>::value, "");
+  U u_;
+
+ public:
+  template <class... Ts>
+  explicit buffer_control_block(Ts&&... ts) : u_(U(std::forward<Ts>(ts)...)) {}
+
+  sbo_control_block<T>* clone(void* buffer) const override {
+    return ::new (buffer) buffer_control_block(*this);
+  }
+
+  sbo_control_block<T>* move_to(void* buffer) noexcept override {
+    return ::new (buffer) buffer_control_block(std::move(*this));
+  }
+
+  T* ptr() override { return std::addressof(u_); }
+
+  void destroy() noexcept override { this->~buffer_control_block(); }
+};
+
+// Heap fallback for types that do not fit the buffer. Moves transfer the
+// allocation rather than the stored object.
+template <class T, class U>
+class heap_control_block final : public sbo_control_block<T> {
+  static_assert(!std::is_reference<U>::value, "");
+  U u_;
+
+ public:
+  template <class... Ts>
+  explicit heap_control_block(Ts&&... ts) : u_(U(std::forward<Ts>(ts)...)) {}
+
+  sbo_control_block<T>* clone(void*) const override {
+    return new heap_control_block(*this);
+  }
+
+  sbo_control_block<T>* move_to(void*) noexcept override { return this; }
+
+  T* ptr() override { return std::addressof(u_); }
+};
+
+}  // end namespace detail
+
+template <class T, std::size_t BufferSize>
+class small_polymorphic_value;
+
+template <class T>
+struct is_small_polymorphic_value : std::false_type {};
+
+template <class T, std::size_t N>
+struct is_small_polymorphic_value<small_polymorphic_value<T, N>>
+    : std::true_type {};
+
+////////////////////////////////////////////////////////////////////////////////
+// `small_polymorphic_value` class definition
+////////////////////////////////////////////////////////////////////////////////
+
+// A polymorphic value type with inline storage. Objects of type `U` that fit
+// in `BufferSize` bytes (after accounting for control-block overhead), are
+// suitably aligned and are nothrow-move-constructible are constructed directly
+// inside the `small_polymorphic_value`; construction, copy and destruction of
+// such objects perform no allocation. Other types fall back to a single heap
+// allocation, as for `polymorphic_value`.
+template <class T, std::size_t BufferSize = 3 * sizeof(void*)>
+class small_polymorphic_value {
+  static_assert(!std::is_union<T>::value, "");
+  static_assert(std::is_class<T>::value, "");
+
+  template <class T_, std::size_t N>
+  friend class small_polymorphic_value;
+
+  template <class T_, std::size_t N, class U, class... Ts>
+  friend small_polymorphic_value<T_, N> make_small_polymorphic_value(
+      Ts&&... ts);
+
+  // The buffer must also hold the control block's vtable pointer.
+  static constexpr std::size_t storage_size = BufferSize + sizeof(void*);
+
+  template <class U>
+  static constexpr bool fits_buffer =
+      sizeof(detail::buffer_control_block<T, U>) <= storage_size &&
+      alignof(detail::buffer_control_block<T, U>) <=
+          alignof(std::max_align_t) &&
+      std::is_nothrow_move_constructible<U>::value;
+
+  alignas(std::max_align_t) unsigned char buffer_[storage_size];
+  T* ptr_ = nullptr;
+  detail::sbo_control_block<T>* cb_ = nullptr;
+
+  template <class U, class... Ts>
+  void construct(Ts&&... ts) {
+    if constexpr (fits_buffer<U>) {
+      cb_ = ::new (static_cast<void*>(buffer_))
+          detail::buffer_control_block<T, U>(std::forward<Ts>(ts)...);
+    } else {
+      cb_ = new detail::heap_control_block<T, U>(std::forward<Ts>(ts)...);
+    }
+    ptr_ = cb_->ptr();
+  }
+
+  void reset() noexcept {
+    if (cb_) {
+      cb_->destroy();
+      cb_ = nullptr;
+      ptr_ = nullptr;
+    }
+  }
+
+ public:
+  //
+  // Destructor
+  //
+
+  ~small_polymorphic_value() { reset(); }
+
+  //
+  // Constructors
+  //
+
+  small_polymorphic_value() {}
+
+  small_polymorphic_value(std::nullptr_t) {}
+
+  //
+  // Copy-constructors
+  //
+
+  small_polymorphic_value(const small_polymorphic_value& p) {
+    if (!p) {
+      return;
+    }
+    cb_ = p.cb_->clone(static_cast<void*>(buffer_));
+    ptr_ = cb_->ptr();
+  }
+
+  //
+  // Move-constructors
+  //
+
+  small_polymorphic_value(small_polymorphic_value&& p) noexcept {
+    if (!p) {
+      return;
+    }
+    cb_ = p.cb_->move_to(static_cast<void*>(buffer_));
+    ptr_ = cb_->ptr();
+    if (cb_ != p.cb_) {
+      p.cb_->destroy();
+    }
+    p.cb_ = nullptr;
+    p.ptr_ = nullptr;
+  }
+
+  //
+  // In-place constructor
+  //
+
+  template <class U,
+            class V = std::enable_if_t<
+                std::is_convertible<std::decay_t<U>*, T*>::value &&
+                !is_small_polymorphic_value<std::decay_t<U>>::value>,
+            class... Ts>
+  explicit small_polymorphic_value(std::in_place_type_t<U>, Ts&&... ts) {
+    construct<U>(std::forward<Ts>(ts)...);
+  }
+
+  //
+  // Assignment
+  //
+
+  small_polymorphic_value& operator=(const small_polymorphic_value& p) {
+    if (std::addressof(p) == this) {
+      return *this;
+    }
+
+    small_polymorphic_value tmp(p);
+    *this = std::move(tmp);
+    return *this;
+  }
+
+  //
+  // Move-assignment
+  //
+
+  small_polymorphic_value& operator=(small_polymorphic_value&& p) noexcept {
+    if (std::addressof(p) == this) {
+      return *this;
+    }
+
+    reset();
+    if (!p) {
+      return *this;
+    }
+    cb_ = p.cb_->move_to(static_cast<void*>(buffer_));
+    ptr_ = cb_->ptr();
+    if (cb_ != p.cb_) {
+      p.cb_->destroy();
+    }
+    p.cb_ = nullptr;
+    p.ptr_ = nullptr;
+    return *this;
+  }
+
+  //
+  // Modifiers
+  //
+
+  void swap(small_polymorphic_value& p) noexcept {
+    small_polymorphic_value tmp(std::move(p));
+    p = std::move(*this);
+    *this = std::move(tmp);
+  }
+
+  //
+  // Observers
+  //
+
+  constexpr explicit operator bool() const { return cb_ != nullptr; }
+
+  // Returns true if the stored object lives inside the buffer.
+  constexpr bool uses_buffer() const noexcept {
+    return static_cast<const void*>(cb_) == static_cast<const void*>(buffer_);
+  }
+
+  constexpr const T* operator->() const {
+    assert(ptr_);
+    return ptr_;
+  }
+
+  constexpr const T& operator*() const {
+    assert(*this);
+    return *ptr_;
+  }
+
+  constexpr T* operator->() {
+    assert(*this);
+    return ptr_;
+  }
+
+  constexpr T& operator*() {
+    assert(*this);
+    return *ptr_;
+  }
+};
+
+//
+// small_polymorphic_value creation
+//
+template <class T, std::size_t BufferSize = 3 * sizeof(void*), class U = T,
+          class... Ts>
+small_polymorphic_value<T, BufferSize> make_small_polymorphic_value(
+    Ts&&... ts) {
+  small_polymorphic_value<T, BufferSize> p;
+  p.template construct<U>(std::forward<Ts>(ts)...);
+  return p;
+}
+
+//
+// non-member swap
+//
+template <class T, std::size_t N>
+void swap(small_polymorphic_value<T, N>& t,
+          small_polymorphic_value<T, N>& u) noexcept {
+  t.swap(u);
+}
+
+}  // namespace isocpp_p0201
+
+#endif  // ISOCPP_P0201_SMALL_POLYMORPHIC_VALUE_H_INCLUDED
@@ -0,0 +1,207 @@
+/* Copyright (c) 2016 The Polymorphic Value Authors. All Rights Reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+==============================================================================*/
+
+#include "small_polymorphic_value.h"
+
+#include <utility>
+
+#undef CATCH_CONFIG_WINDOWS_SEH
+#include "catch2/catch_test_macros.hpp"
+
+using namespace isocpp_p0201;
+
+namespace {
+struct SmallBase {
+  virtual int value() const = 0;
+  virtual void set_value(int) = 0;
+  virtual ~SmallBase() = default;
+};
+
+struct SmallDerived : SmallBase {
+  int value_ = 0;
+
+  SmallDerived() { ++object_count; }
+
+  SmallDerived(const SmallDerived& d) : value_(d.value_) { ++object_count; }
+
+  SmallDerived(SmallDerived&& d) noexcept : value_(d.value_) { ++object_count; }
+
+  SmallDerived(int v) : value_(v) { ++object_count; }
+
+  ~SmallDerived() { --object_count; }
+
+  int value() const override { return value_; }
+
+  void set_value(int i) override { value_ = i; }
+
+  static size_t object_count;
+};
+
+size_t SmallDerived::object_count = 0;
+
+// Too large for the default buffer; forces the heap fallback.
+struct LargeDerived : SmallBase {
+  int value_ = 0;
+  char padding_[128] = {};
+
+  LargeDerived(int v) : value_(v) {}
+
+  int value() const override { return value_; }
+
+  void set_value(int i) override { value_ = i; }
+};
+
+}  // namespace
+
+TEST_CASE("small_polymorphic_value default constructor",
+          "[small_polymorphic_value.constructors]") {
+  small_polymorphic_value<SmallBase> p;
+
+  REQUIRE_FALSE(bool(p));
+}
+
+TEST_CASE("small_polymorphic_value stores small objects in the buffer",
+          "[small_polymorphic_value.buffer]") {
+  small_polymorphic_value<SmallBase> p(std::in_place_type<SmallDerived>, 7);
+
+  REQUIRE(bool(p));
+  REQUIRE(p->value() == 7);
+  REQUIRE(p.uses_buffer());
+
+  THEN("the stored object lives inside the object footprint") {
+    const void* begin = &p;
+    const void* end = &p + 1;
+    const void* object = p.operator->();
+    REQUIRE(object >= begin);
+    REQUIRE(object < end);
+  }
+}
+
+TEST_CASE("small_polymorphic_value falls back to the heap for large objects",
+          "[small_polymorphic_value.buffer]") {
+  small_polymorphic_value<SmallBase> p(std::in_place_type<LargeDerived>, 7);
+
+  REQUIRE(bool(p));
+  REQUIRE(p->value() == 7);
+  REQUIRE_FALSE(p.uses_buffer());
+}
+
+TEST_CASE("small_polymorphic_value copy constructor",
+          "[small_polymorphic_value.constructors]") {
+  GIVEN("A buffer-stored small_polymorphic_value") {
+    REQUIRE(SmallDerived::object_count == 0);
+
+    small_polymorphic_value<SmallBase> p(std::in_place_type<SmallDerived>, 7);
+    small_polymorphic_value<SmallBase> q(p);
+
+    THEN("the copy is buffer-stored and distinct") {
+      REQUIRE(q.uses_buffer());
+      REQUIRE(q.operator->() != p.operator->());
+      REQUIRE(q->value() == 7);
+      REQUIRE(SmallDerived::object_count == 2);
+    }
+
+    WHEN("the original is modified") {
+      p->set_value(99);
+      THEN("the copy is unchanged") { REQUIRE(q->value() == 7); }
+    }
+  }
+  REQUIRE(SmallDerived::object_count == 0);
+}
+
+TEST_CASE("small_polymorphic_value move constructor",
+          "[small_polymorphic_value.constructors]") {
+  GIVEN("A buffer-stored small_polymorphic_value") {
+    small_polymorphic_value<SmallBase> p(std::in_place_type<SmallDerived>, 7);
+
+    small_polymorphic_value<SmallBase> q(std::move(p));
+
+    THEN("the source is empty and the value is transferred") {
+      REQUIRE_FALSE(bool(p));
+      REQUIRE(bool(q));
+      REQUIRE(q->value() == 7);
+      REQUIRE(q.uses_buffer());
+      REQUIRE(SmallDerived::object_count == 1);
+    }
+  }
+
+  GIVEN("A heap-stored small_polymorphic_value") {
+    small_polymorphic_value<SmallBase> p(std::in_place_type<LargeDerived>, 7);
+    const auto* stored = p.operator->();
+
+    small_polymorphic_value<SmallBase> q(std::move(p));
+
+    THEN("the allocation is transferred without copying") {
+      REQUIRE_FALSE(bool(p));
+      REQUIRE(q.operator->() == stored);
+      REQUIRE(q->value() == 7);
+    }
+  }
+}
+
+TEST_CASE("small_polymorphic_value assignment",
+          "[small_polymorphic_value.assignment]") {
+  small_polymorphic_value<SmallBase> p(std::in_place_type<SmallDerived>, 7);
+  small_polymorphic_value<SmallBase> q(std::in_place_type<SmallDerived>, 87);
+
+  q = p;
+
+  REQUIRE(q->value() == 7);
+  REQUIRE(q.operator->() != p.operator->());
+
+  q = std::move(p);
+
+  REQUIRE_FALSE(bool(p));
+  REQUIRE(q->value() == 7);
+
+  q = q;
+
+  REQUIRE(q->value() == 7);
+}
+
+TEST_CASE("small_polymorphic_value destruction",
+          "[small_polymorphic_value.destructor]") {
+  REQUIRE(SmallDerived::object_count == 0);
+  {
+    small_polymorphic_value<SmallBase> p(std::in_place_type<SmallDerived>);
+    REQUIRE(SmallDerived::object_count == 1);
+  }
+  REQUIRE(SmallDerived::object_count == 0);
+}
+
+TEST_CASE("make_small_polymorphic_value",
+          "[small_polymorphic_value.make_small_polymorphic_value]") {
+  auto p = make_small_polymorphic_value<SmallBase, 3 * sizeof(void*),
+                                        SmallDerived>(7);
+  static_assert(
+      std::is_same<decltype(p), small_polymorphic_value<SmallBase>>::value, "");
+  REQUIRE(p->value() == 7);
+  REQUIRE(p.uses_buffer());
+}
+
+TEST_CASE("small_polymorphic_value swap", "[small_polymorphic_value.swap]") {
+  small_polymorphic_value<SmallBase> p(std::in_place_type<SmallDerived>, 7);
+  small_polymorphic_value<SmallBase> q(std::in_place_type<LargeDerived>, 87);
+
+  swap(p, q);
+
+  REQUIRE(p->value() == 87);
+  REQUIRE(q->value() == 7);
+}